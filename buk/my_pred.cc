@@ -3,9 +3,6 @@
 #include <sstream>
 #include <stdio.h>
 
-// global variable
-MyPred my_pred;
-
 std::string MyPred::get_br_id(uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
     std::stringstream ss;
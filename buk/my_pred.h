@@ -43,6 +43,3 @@ public:
 };
 
 #endif
-
-// global variable
-extern MyPred my_pred;
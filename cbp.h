@@ -15,64 +15,142 @@
 */
 
 #pragma once
+#include <string>
+#include <vector>
 #include "lib/sim_common_structs.h"
 
 //
-// beginCondDirPredictor()
-// 
-// This function is called by the simulator before the start of simulation.
-// It can be used for arbitrary initialization steps for the contestant's code.
+// NotifySubscription
 //
-extern void beginCondDirPredictor();
-
-//
-// get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
-// 
-// This function is called by the simulator for predicting conditional branches.
-// input values are unique identifying ids(seq_no, piece) and PC of the branch.
-// return value is the predicted direction. 
+// Instruction classes each notify_instr_* hook of a predictor is called for, as bit sets of (1 << InstClass)
+// (see CondDirPredictor::get_notify_subscription()). By default, every hook is called for every instruction.
 //
-extern bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle);
+typedef uint16_t InstClassMask;
 
-//
-// spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
-// 
-// This function is called by the simulator for updating the history vectors and any state that needs to be updated speculatively.
-// The function is called for all the branches (not just conditional branches). To faciliate accurate history updates, spec_update is called right
-// after a prediction is made.
-// input values are unique identifying ids(seq_no, piece), PC of the instruction, instruction class, predicted/resolve direction and the next_pc 
-//
-extern void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc);
+inline constexpr InstClassMask inst_class_bit(InstClass inst_class)
+{
+    return static_cast<InstClassMask>(1 << static_cast<uint8_t>(inst_class));
+}
 
-//
-// notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle)
-// 
-// This function is called when any instructions(not just branches) gets decoded.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, decode info and cycle are also provided as inputs
-//
-extern void notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle);
+inline bool inst_class_in(InstClassMask mask, InstClass inst_class)
+{
+    return (mask & inst_class_bit(inst_class)) != 0;
+}
+
+static constexpr InstClassMask NO_INST_CLASSES = 0;
+static constexpr InstClassMask ALL_INST_CLASSES = 0xffff;
+static constexpr InstClassMask COND_BRANCH_INST_CLASSES = inst_class_bit(InstClass::condBranchInstClass);
+static constexpr InstClassMask BRANCH_INST_CLASSES = inst_class_bit(InstClass::condBranchInstClass) | inst_class_bit(InstClass::uncondDirectBranchInstClass) |
+                                                     inst_class_bit(InstClass::uncondIndirectBranchInstClass) | inst_class_bit(InstClass::callDirectInstClass) |
+                                                     inst_class_bit(InstClass::callIndirectInstClass) | inst_class_bit(InstClass::ReturnInstClass);
+
+struct NotifySubscription
+{
+    InstClassMask decode = ALL_INST_CLASSES;
+    InstClassMask execute = ALL_INST_CLASSES;
+    InstClassMask commit = ALL_INST_CLASSES;
+};
 
 //
-// notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle)
-// 
-// This function is called when any instructions(not just branches) gets executed.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+// CondDirPredictor
 //
-extern void notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle);
+// The interface between the simulator and a conditional branch direction predictor. Predictors are instances of
+// classes implementing it, registered by name (see registerCondDirPredictor() below) and selected at run time with
+// -m <name>. Several instances can coexist in one process: the multi-predictor harness
+// (-X predictor-only -m <name>,<name>...) decodes a trace once and presents every branch to each of them.
+//
+class CondDirPredictor
+{
+public:
+    virtual ~CondDirPredictor() {}
+
+    //
+    // beginCondDirPredictor()
+    //
+    // This function is called by the simulator before the start of simulation.
+    // It can be used for arbitrary initialization steps for the contestant's code.
+    //
+    virtual void beginCondDirPredictor() = 0;
+
+    //
+    // get_notify_subscription()
+    //
+    // This function is called by the simulator right after beginCondDirPredictor().
+    // It returns the instruction classes notify_instr_decode, notify_instr_execute_resolve and notify_instr_commit are
+    // called for: the simulator does not make the other calls. By default, they are called for all instructions.
+    //
+    virtual NotifySubscription get_notify_subscription() const
+    {
+        return NotifySubscription();
+    }
+
+    //
+    // get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
+    //
+    // This function is called by the simulator for predicting conditional branches.
+    // input values are unique identifying ids(seq_no, piece) and PC of the branch.
+    // return value is the predicted direction.
+    //
+    virtual bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle) = 0;
+
+    //
+    // spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
+    //
+    // This function is called by the simulator for updating the history vectors and any state that needs to be updated speculatively.
+    // The function is called for all the branches (not just conditional branches). To faciliate accurate history updates, spec_update is called right
+    // after a prediction is made.
+    // input values are unique identifying ids(seq_no, piece), PC of the instruction, instruction class, predicted/resolve direction and the next_pc
+    //
+    virtual void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc) = 0;
+
+    //
+    // notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets decoded.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, decode info and cycle are also provided as inputs
+    //
+    virtual void notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle) = 0;
+
+    //
+    // notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets executed.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+    //
+    virtual void notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle) = 0;
+
+    //
+    // notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets committed.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+    //
+    virtual void notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle) = 0;
+
+    //
+    // endCondDirPredictor()
+    //
+    // This function is called by the simulator at the end of simulation.
+    // It can be used by the contestant to print out other contestant-specific measurements.
+    //
+    virtual void endCondDirPredictor() = 0;
+};
 
 //
-// notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle)
-// 
-// This function is called when any instructions(not just branches) gets committed.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+// registerCondDirPredictor(const char * name, CondDirPredictorFactory factory)
 //
-extern void notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle);
-
+// Makes a predictor available by name. Returns true, so that it can be called from a static initializer:
+//   static const bool registered = registerCondDirPredictor("my_pred", []() -> CondDirPredictor* { return new MyPredictor(); });
+//
+typedef CondDirPredictor * (*CondDirPredictorFactory)();
+extern bool registerCondDirPredictor(const char * name, CondDirPredictorFactory factory);
 
 //
-// endCondDirPredictor()
+// createCondDirPredictor(const std::string& name)
 //
-// This function is called by the simulator at the end of simulation.
-// It can be used by the contestant to print out other contestant-specific measurements.
+// Returns a new instance of the predictor registered under name, or nullptr if there is none.
 //
-extern void endCondDirPredictor();
+extern CondDirPredictor * createCondDirPredictor(const std::string& name);
+
+// Names of the registered predictors, sorted.
+extern std::vector<std::string> listCondDirPredictors();
@@ -17,122 +17,154 @@
 // This file provides a sample predictor integration based on the interface provided.
 
 #include "lib/sim_common_structs.h"
+#include "cbp.h"
 #include "base_pred.h"
 #include "my_pred.h"
 #include <cassert>
 
 //
-// beginCondDirPredictor()
+// SamplePredictor
 //
-// This function is called by the simulator before the start of simulation.
-// It can be used for arbitrary initialization steps for the contestant's code.
+// Integrates a predictor with the init/fini/predict/spec_update/update/commit interface of MyPred and BimodalPred.
+// Each instance owns its predictor, so that several of them can coexist (-X predictor-only -m my_pred,bimodal).
 //
-void beginCondDirPredictor()
+static void commit_pred(MyPred &pred, uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
-    // setup sample_predictor
-    // base_bp.init();
-    my_pred.init();
+    pred.commit(seq_no, piece, pc);
 }
 
-//
-// get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
-//
-// This function is called by the simulator for predicting conditional branches.
-// input values are unique identifying ids(seq_no, piece) and PC of the branch.
-// return value is the predicted direction.
-//
-bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
+static void commit_pred(BimodalPred &pred, uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
-    // const bool base_bp_pred = base_bp.predict(seq_no, piece, pc);
-    const bool my_bp_pred = my_pred.predict(seq_no, piece, pc);
-
-    // You can chose either of the preidctions
-    // or do some consensus. Whatever you wish!
-    // return (my_bp_pred == base_bp_pred) ? my_bp_pred : base_bp_pred;
-    return my_bp_pred;
-
 }
 
-//
-// spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
-//
-// This function is called by the simulator for updating the history vectors and any state that needs to be updated speculatively.
-// The function is called for all the branches (not just conditional branches). To faciliate accurate history updates, spec_update is called right
-// after a prediction is made.
-// input values are unique identifying ids(seq_no, piece), PC of the instruction, instruction class, predicted/resolve direction and the next_pc
-//
-void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
+template <typename Pred>
+class SamplePredictor : public CondDirPredictor
 {
-    assert(is_br(inst_class));
+public:
+    //
+    // beginCondDirPredictor()
+    //
+    // This function is called by the simulator before the start of simulation.
+    // It can be used for arbitrary initialization steps for the contestant's code.
+    //
+    void beginCondDirPredictor() override
+    {
+        // setup sample_predictor
+        pred.init();
+    }
 
-    if (is_cond_br(inst_class))
+    //
+    // get_notify_subscription()
+    //
+    // This function is called by the simulator right after beginCondDirPredictor().
+    // It returns the instruction classes the notify_instr_* functions below are called for.
+    //
+    // The sample predictor does not use decode information, and only updates on conditional branches
+    // (other branches are only checked to have been predicted taken at execute).
+    NotifySubscription get_notify_subscription() const override
     {
-        // base_bp.spec_update(seq_no, piece, pc, resolve_dir, pred_dir, next_pc);
-        my_pred.spec_update(seq_no, piece, pc, resolve_dir, pred_dir, next_pc);
+        NotifySubscription subscription;
+        subscription.decode = NO_INST_CLASSES;
+        subscription.execute = BRANCH_INST_CLASSES;
+        subscription.commit = COND_BRANCH_INST_CLASSES;
+        return subscription;
     }
-}
 
-//
-// notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle)
-//
-// This function is called when any instructions(not just branches) gets decoded.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, decode info and cycle are also provided as inputs
-//
-// For the sample predictor implementation, we do not leverage decode information
-void notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo &_decode_info, const uint64_t decode_cycle)
-{
-}
+    //
+    // get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
+    //
+    // This function is called by the simulator for predicting conditional branches.
+    // input values are unique identifying ids(seq_no, piece) and PC of the branch.
+    // return value is the predicted direction.
+    //
+    bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle) override
+    {
+        return pred.predict(seq_no, piece, pc);
+    }
 
-//
-// notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle)
-//
-// This function is called when any instructions(not just branches) gets executed.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
-//
-// For conditional branches, we use this information to update the predictor.
-// At the moment, we do not consider updating any other structure, but the contestants are allowed to  update any other predictor state.
-void notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t execute_cycle)
-{
-    const bool is_branch = is_br(_exec_info.dec_info.insn_class);
-    if (is_branch)
+    //
+    // spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
+    //
+    // This function is called by the simulator for updating the history vectors and any state that needs to be updated speculatively.
+    // The function is called for all the branches (not just conditional branches). To faciliate accurate history updates, spec_update is called right
+    // after a prediction is made.
+    // input values are unique identifying ids(seq_no, piece), PC of the instruction, instruction class, predicted/resolve direction and the next_pc
+    //
+    void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc) override
+    {
+        assert(is_br(inst_class));
+
+        if (is_cond_br(inst_class))
+        {
+            pred.spec_update(seq_no, piece, pc, resolve_dir, pred_dir, next_pc);
+        }
+    }
+
+    //
+    // notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets decoded.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, decode info and cycle are also provided as inputs
+    //
+    // For the sample predictor implementation, we do not leverage decode information
+    void notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo &_decode_info, const uint64_t decode_cycle) override
+    {
+    }
+
+    //
+    // notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets executed.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+    //
+    // For conditional branches, we use this information to update the predictor.
+    // At the moment, we do not consider updating any other structure, but the contestants are allowed to  update any other predictor state.
+    void notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t execute_cycle) override
     {
-        if (is_cond_br(_exec_info.dec_info.insn_class))
+        const bool is_branch = is_br(_exec_info.dec_info.insn_class);
+        if (is_branch)
         {
-            const bool _resolve_dir = _exec_info.taken.value();
-            const uint64_t _next_pc = _exec_info.next_pc;
-            // base_bp.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
-            my_pred.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
+            if (is_cond_br(_exec_info.dec_info.insn_class))
+            {
+                const bool _resolve_dir = _exec_info.taken.value();
+                const uint64_t _next_pc = _exec_info.next_pc;
+                pred.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
+            }
+            else
+            {
+                assert(pred_dir);
+            }
         }
-        else
+    }
+
+    //
+    // notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets committed.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+    //
+    void notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t commit_cycle) override
+    {
+        if (is_br(_exec_info.dec_info.insn_class) && is_cond_br(_exec_info.dec_info.insn_class))
         {
-            assert(pred_dir);
+            commit_pred(pred, seq_no, piece, pc);
         }
     }
-}
 
-//
-// notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle)
-//
-// This function is called when any instructions(not just branches) gets committed.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
-//
-// For the sample predictor implementation, we do not leverage commit information
-void notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t commit_cycle)
-{
-    if (is_br(_exec_info.dec_info.insn_class) && is_cond_br(_exec_info.dec_info.insn_class))
+    //
+    // endCondDirPredictor()
+    //
+    // This function is called by the simulator at the end of simulation.
+    // It can be used by the contestant to print out other contestant-specific measurements.
+    //
+    void endCondDirPredictor() override
     {
-        my_pred.commit(seq_no, piece, pc);
+        pred.fini();
     }
-}
 
-//
-// endCondDirPredictor()
-//
-// This function is called by the simulator at the end of simulation.
-// It can be used by the contestant to print out other contestant-specific measurements.
-//
-void endCondDirPredictor()
-{
-    // base_bp.fini();
-    my_pred.fini();
-}
+private:
+    Pred pred;
+};
+
+static const bool my_pred_registered = registerCondDirPredictor("my_pred", []() -> CondDirPredictor * { return new SamplePredictor<MyPred>(); });
+static const bool bimodal_registered = registerCondDirPredictor("bimodal", []() -> CondDirPredictor * { return new SamplePredictor<BimodalPred>(); });
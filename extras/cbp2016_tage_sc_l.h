@@ -7,10 +7,10 @@
 #include <inttypes.h>
 #include <math.h>
 #include <stdio.h>
-#include <unordered_map>
 #include <vector>
 #include <array>
 #include <iostream>
+#include "lib/folded_history.h"
 
 
 //parameters of the loop predictor
@@ -43,9 +43,6 @@
 //The three BIAS tables in the SC component
 //We play with the TAGE  confidence here, with the number of the hitting bank
 #define LOGBIAS 8
-int8_t Bias[(1 << LOGBIAS)];
-int8_t BiasSK[(1 << LOGBIAS)];
-int8_t BiasBank[(1 << LOGBIAS)];
 
 //In all th GEHL components, the two tables with the shortest history lengths have only half of the entries.
 
@@ -53,64 +50,43 @@ int8_t BiasBank[(1 << LOGBIAS)];
 #ifdef IMLI
 #define LOGINB 8        // 128-entry
 #define INB 1
-int Im[INB] = { 8 };
-int8_t IGEHLA[INB][(1 << LOGINB)] = { {0} };
 
-int8_t *IGEHL[INB];
 
 #define LOGIMNB 9       // 2* 256 -entry
 #define IMNB 2
 
-int IMm[IMNB] = { 10, 4 };
-int8_t IMGEHLA[IMNB][(1 << LOGIMNB)] = { {0} };
 
-int8_t *IMGEHL[IMNB];
 
 #endif
 
 //global branch GEHL
 #define LOGGNB 10       // 1 1K + 2 * 512-entry tables
 #define GNB 3
-int Gm[GNB] = { 40, 24, 10 };
-int8_t GGEHLA[GNB][(1 << LOGGNB)] = { {0} };
 
-int8_t *GGEHL[GNB];
 
 //variation on global branch history
 #define PNB 3
 #define LOGPNB 9        // 1 1K + 2 * 512-entry tables
-int Pm[PNB] = { 25, 16, 9 };
-int8_t PGEHLA[PNB][(1 << LOGPNB)] = { {0} };
 
-int8_t *PGEHL[PNB];
 
 //first local history
 #define LOGLNB  10      // 1 1K + 2 * 512-entry tables
 #define LNB 3
-int Lm[LNB] = { 11, 6, 3 };
-int8_t LGEHLA[LNB][(1 << LOGLNB)] = { {0} };
 
-int8_t *LGEHL[LNB];
 #define  LOGLOCAL 8
 #define NLOCAL (1<<LOGLOCAL)
 
 // second local history
 #define LOGSNB 9        // 1 1K + 2 * 512-entry tables
 #define SNB 3
-int Sm[SNB] = { 16, 11, 6 };
-int8_t SGEHLA[SNB][(1 << LOGSNB)] = { {0} };
 
-int8_t *SGEHL[SNB];
 #define LOGSECLOCAL 4
 #define NSECLOCAL (1<<LOGSECLOCAL)  //Number of second local histories
 
 //third local history
 #define LOGTNB 10       // 2 * 512-entry tables
 #define TNB 2
-int Tm[TNB] = { 9, 4 };
-int8_t TGEHLA[TNB][(1 << LOGTNB)] = { {0} };
 
-int8_t *TGEHL[TNB];
 #define NTLOCAL 16
 
 
@@ -126,24 +102,11 @@ int8_t *TGEHL[TNB];
 #define LOGSIZEUP 0
 #endif
 #define LOGSIZEUPS  (LOGSIZEUP/2)
-int updatethreshold;
-int Pupdatethreshold[(1 << LOGSIZEUP)]; //size is fixed by LOGSIZEUP
 #define INDUPD (PC ^ (PC >>2)) & ((1 << LOGSIZEUP) - 1)
 #define INDUPDS ((PC ^ (PC >>2)) & ((1 << (LOGSIZEUPS)) - 1))
-int8_t WG[(1 << LOGSIZEUPS)];
-int8_t WL[(1 << LOGSIZEUPS)];
-int8_t WS[(1 << LOGSIZEUPS)];
-int8_t WT[(1 << LOGSIZEUPS)];
-int8_t WP[(1 << LOGSIZEUPS)];
-int8_t WI[(1 << LOGSIZEUPS)];
-int8_t WIM[(1 << LOGSIZEUPS)];
-int8_t WB[(1 << LOGSIZEUPS)];
 #define EWIDTH 6
-int LSUM;
 
 // The two counters used to choose between TAGE and SC on Low Conf SC
-int8_t FirstH, SecondH;
-bool MedConf;           // is the TAGE prediction medium confidence
 
 
 #define CONFWIDTH 7     //for the counters in the choser
@@ -194,7 +157,6 @@ class gentry            // TAGE global table entry
 #define NBANKLOW 10     // number of banks in the shared bank-interleaved for the low history lengths
 #define NBANKHIGH 20        // number of banks in the shared bank-interleaved for the  history lengths
 
-int SizeTable[NHIST + 1];
 
 
 #define BORN 13         // below BORN in the table for low history lengths, >= BORN in the table for high history lengths,
@@ -213,7 +175,6 @@ int SizeTable[NHIST + 1];
 #define TBITS 8         //minimum width of the tags  (low history lengths), +4 for high history lengths
 
 
-bool NOSKIP[NHIST + 1];     // to manage the associativity for different history lengths
 
 
 
@@ -229,15 +190,11 @@ bool NOSKIP[NHIST + 1];     // to manage the associativity for different history
 
 //the counter(s) to chose between longest match and alternate prediction on TAGE when weak counters
 #define LOGSIZEUSEALT 4
-bool AltConf;           // Confidence on the alternate prediction
 #define ALTWIDTH 5
 #define SIZEUSEALT  (1<<(LOGSIZEUSEALT))
 #define INDUSEALT (((((HitBank-1)/8)<<1)+AltConf) % (SIZEUSEALT-1))
-int8_t use_alt_on_na[SIZEUSEALT];
 //very marginal benefit
-int8_t BIM;
 
-int TICK;           // for the reset of the u counter
 //uint8_t ghist[HISTBUFFERLENGTH];
 //int ptghist;
 //uint64_t phist;      //path history
@@ -268,47 +225,11 @@ class lentry            //loop predictor entry
 };
 
 //For the TAGE predictor
-bentry *btable;         //bimodal TAGE table
-gentry *gtable[NHIST + 1];  // tagged TAGE tables
-lentry *ltable;
-int m[NHIST + 1];
-int TB[NHIST + 1];
-int logg[NHIST + 1];
 
-uint64_t Seed;           // for the pseudo-random number generator
 
 
-class folded_history
-{
-    public:
-        unsigned comp;
-        int CLENGTH;
-        int OLENGTH;
-        int OUTPOINT;
-
-        folded_history ()
-        {
-        }
-
-        void init (int original_length, int compressed_length)
-        {
-            comp = 0;
-            OLENGTH = original_length;
-            CLENGTH = compressed_length;
-            OUTPOINT = OLENGTH % CLENGTH;
-
-        }
-
-        void update (std::array<uint8_t, HISTBUFFERLENGTH>&h, int PT)
-        {
-            comp = (comp << 1) ^ h[PT & (HISTBUFFERLENGTH - 1)];
-            comp ^= h[(PT + OLENGTH) & (HISTBUFFERLENGTH - 1)] << OUTPOINT;
-            comp ^= (comp >> CLENGTH);
-            comp = (comp) & ((1 << CLENGTH) - 1);
-        }
-};
-using tage_index_t = std::array<folded_history, NHIST+1>;
-using tage_tag_t = std::array<folded_history, NHIST+1>;
+// folded histories for computing the TAGE indices and tags (lib/folded_history.h)
+using tage_folded_history_t = folded_history_bank_t<NHIST+1>;
 
 
 struct cbp_hist_t
@@ -318,8 +239,7 @@ struct cbp_hist_t
       std::array<uint8_t, HISTBUFFERLENGTH> ghist;
       uint64_t phist;      //path history
       int ptghist;
-      tage_index_t ch_i;
-      std::array<tage_tag_t, 2> ch_t;
+      tage_folded_history_t ch;
 
       std::array<uint64_t, NLOCAL> L_shist;
       std::array<uint64_t, NSECLOCAL> S_slhist;
@@ -329,106 +249,36 @@ struct cbp_hist_t
       uint64_t IMLIcount;      // use to monitor the iteration number
 };
 
+// What the prediction of a conditional branch computed from the history, kept until its update: the TAGE indices and tags,
+// and the indices of the SC GEHL tables. They only depend on the PC and on the history at prediction time, so the update
+// reuses them rather than checkpointing the history and hashing it again.
+// The matching banks and the counter sums depend on the tables, which other branches may have updated in between:
+// they are looked up again at update.
+static_assert((TBITS + 4 <= 16) && (LOGGNB <= 16) && (LOGPNB <= 16) && (LOGLNB <= 16) && (LOGSNB <= 16) && (LOGTNB <= 16),
+              "tags and GEHL indices are recorded on 16 bits");
 
+#define INVALID_INST_ID (~0ULL)
 
-int predictorsize ()
+struct cbp_pred_record_t
 {
-    int STORAGESIZE = 0;
-    int inter = 0;
-
-
-
-    STORAGESIZE +=
-        NBANKHIGH * (1 << (logg[BORN])) * (CWIDTH + UWIDTH + TB[BORN]);
-    STORAGESIZE += NBANKLOW * (1 << (logg[1])) * (CWIDTH + UWIDTH + TB[1]);
-
-    STORAGESIZE += (SIZEUSEALT) * ALTWIDTH;
-    STORAGESIZE += (1 << LOGB) + (1 << (LOGB - HYSTSHIFT));
-    STORAGESIZE += m[NHIST];
-    STORAGESIZE += PHISTWIDTH;
-    STORAGESIZE += 10;      //the TICK counter
-
-    fprintf (stderr, " (TAGE %d) ", STORAGESIZE);
-#ifdef SC
-#ifdef LOOPPREDICTOR
-
-    inter = (1 << LOGL) * (2 * WIDTHNBITERLOOP + LOOPTAG + 4 + 4 + 1);
-    fprintf (stderr, " (LOOP %d) ", inter);
-    STORAGESIZE += inter;
-#endif
-
-    inter += WIDTHRES;
-    inter = WIDTHRESP * ((1 << LOGSIZEUP)); //the update threshold counters
-    inter += 3 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
-    inter += (PERCWIDTH) * 3 * (1 << (LOGBIAS));
-
-    inter +=
-        (GNB - 2) * (1 << (LOGGNB)) * (PERCWIDTH) +
-        (1 << (LOGGNB - 1)) * (2 * PERCWIDTH);
-    inter += Gm[0];     //global histories for SC
-    inter += (PNB - 2) * (1 << (LOGPNB)) * (PERCWIDTH) +
-        (1 << (LOGPNB - 1)) * (2 * PERCWIDTH);
-    //we use phist already counted for these tables
-
-#ifdef LOCALH
-    inter +=
-        (LNB - 2) * (1 << (LOGLNB)) * (PERCWIDTH) +
-        (1 << (LOGLNB - 1)) * (2 * PERCWIDTH);
-    inter += NLOCAL * Lm[0];
-    inter += EWIDTH * (1 << LOGSIZEUPS);
-#ifdef LOCALS
-    inter +=
-        (SNB - 2) * (1 << (LOGSNB)) * (PERCWIDTH) +
-        (1 << (LOGSNB - 1)) * (2 * PERCWIDTH);
-    inter += NSECLOCAL * (Sm[0]);
-    inter += EWIDTH * (1 << LOGSIZEUPS);
-
-#endif
-#ifdef LOCALT
-    inter +=
-        (TNB - 2) * (1 << (LOGTNB)) * (PERCWIDTH) +
-        (1 << (LOGTNB - 1)) * (2 * PERCWIDTH);
-    inter += NTLOCAL * Tm[0];
-    inter += EWIDTH * (1 << LOGSIZEUPS);
-#endif
-
-
-
-
-
-
-
-
-
-#endif
-
+      uint64_t id = INVALID_INST_ID;      // unique inst id of the branch, INVALID_INST_ID if the slot is free
 
+      std::array<int, NHIST + 1> GI;
+      std::array<uint16_t, NHIST + 1> GTAG;
 
+      std::array<std::array<uint16_t, GNB>, 2> G_index;     // by pred_inter
+      std::array<uint16_t, PNB> P_index;
+      std::array<uint16_t, LNB> L_index;
+      std::array<uint16_t, SNB> S_index;
+      std::array<uint16_t, TNB> T_index;
 #ifdef IMLI
-
-    inter += (1 << (LOGINB - 1)) * PERCWIDTH;
-    inter += Im[0];
-
-    inter += IMNB * (1 << (LOGIMNB - 1)) * PERCWIDTH;
-    inter += 2 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
-    inter += 256 * IMm[0];
+      std::array<uint16_t, IMNB> IM_index;
+      std::array<uint16_t, INB> I_index;
 #endif
-    inter += 2 * CONFWIDTH; //the 2 counters in the choser
-    STORAGESIZE += inter;
-
+};
 
-    fprintf (stderr, " (SC %d) ", inter);
-#endif
-#ifdef PRINTSIZE
-    fprintf (stderr, " (TOTAL %d bits %d Kbits) ", STORAGESIZE,
-            STORAGESIZE / 1024);
-    fprintf (stdout, " (TOTAL %d bits %d Kbits) ", STORAGESIZE,
-            STORAGESIZE / 1024);
-#endif
 
 
-    return (STORAGESIZE);
-}
 
 // The interface to the simulator is defined in cond_branch_predictor_interface.cc
 // This predictor is a modified version of CBP2016 Tage.
@@ -438,14 +288,66 @@ int predictorsize ()
 // * spec_update -> This is used for updating the history. It provides the actual direction of the branch. This is invoked for all branches.
 // * notify_instr_execute_resolve -> This hook is used to update the predictor. This is invoked for all the instructions and provides all information available at execute.
 //    * Note: The history at update is different than history at predict. To ensure that the predictor is getting trained correctly, 
-//    at predict, we checkpoint the history in an unordered_map(pred_time_histories) using unique identifying id of the instruction. 
-//    When updating the predicor, we recover the prediction time history.
+//    at predict, we record the indices and tags computed from the history (cbp_pred_record_t) in a ring indexed by the seq_no of the instruction (pred_records). 
+//    When updating the predicor, we recover the prediction time indices and tags.
 // There are a couple of other hooks that aren't used in the current implementation, but are available to exploit:
 // * notify_instr_decode 
 // * notify_instr_commit
 class CBP2016_TAGE_SC_L
 {
     public:
+        // Predictor tables and parameters, per instance
+        int8_t Bias[(1 << LOGBIAS)] = {};
+        int8_t BiasSK[(1 << LOGBIAS)] = {};
+        int8_t BiasBank[(1 << LOGBIAS)] = {};
+        int Im[INB] = { 8 };
+        int8_t IGEHLA[INB][(1 << LOGINB)] = { {0} };
+        int8_t *IGEHL[INB] = {};
+        int IMm[IMNB] = { 10, 4 };
+        int8_t IMGEHLA[IMNB][(1 << LOGIMNB)] = { {0} };
+        int8_t *IMGEHL[IMNB] = {};
+        int Gm[GNB] = { 40, 24, 10 };
+        int8_t GGEHLA[GNB][(1 << LOGGNB)] = { {0} };
+        int8_t *GGEHL[GNB] = {};
+        int Pm[PNB] = { 25, 16, 9 };
+        int8_t PGEHLA[PNB][(1 << LOGPNB)] = { {0} };
+        int8_t *PGEHL[PNB] = {};
+        int Lm[LNB] = { 11, 6, 3 };
+        int8_t LGEHLA[LNB][(1 << LOGLNB)] = { {0} };
+        int8_t *LGEHL[LNB] = {};
+        int Sm[SNB] = { 16, 11, 6 };
+        int8_t SGEHLA[SNB][(1 << LOGSNB)] = { {0} };
+        int8_t *SGEHL[SNB] = {};
+        int Tm[TNB] = { 9, 4 };
+        int8_t TGEHLA[TNB][(1 << LOGTNB)] = { {0} };
+        int8_t *TGEHL[TNB] = {};
+        int updatethreshold = 0;
+        int Pupdatethreshold[(1 << LOGSIZEUP)] = {}; //size is fixed by LOGSIZEUP
+        int8_t WG[(1 << LOGSIZEUPS)] = {};
+        int8_t WL[(1 << LOGSIZEUPS)] = {};
+        int8_t WS[(1 << LOGSIZEUPS)] = {};
+        int8_t WT[(1 << LOGSIZEUPS)] = {};
+        int8_t WP[(1 << LOGSIZEUPS)] = {};
+        int8_t WI[(1 << LOGSIZEUPS)] = {};
+        int8_t WIM[(1 << LOGSIZEUPS)] = {};
+        int8_t WB[(1 << LOGSIZEUPS)] = {};
+        int LSUM = 0;
+        int8_t FirstH = 0, SecondH = 0;
+        bool MedConf = false; // is the TAGE prediction medium confidence
+        int SizeTable[NHIST + 1] = {};
+        bool NOSKIP[NHIST + 1] = {}; // to manage the associativity for different history lengths
+        bool AltConf = false; // Confidence on the alternate prediction
+        int8_t use_alt_on_na[SIZEUSEALT] = {};
+        int8_t BIM = 0;
+        int TICK = 0; // for the reset of the u counter
+        bentry *btable = nullptr; //bimodal TAGE table
+        gentry *gtable[NHIST + 1] = {}; // tagged TAGE tables
+        lentry *ltable = nullptr;
+        int m[NHIST + 1] = {};
+        int TB[NHIST + 1] = {};
+        int logg[NHIST + 1] = {};
+        uint64_t Seed = 0; // for the pseudo-random number generator
+
         //state set by predict
         int GI[NHIST + 1];      // indexes to the different tables are computed only once  
         uint GTAG[NHIST + 1];   // tags for the different tables are computed only once  
@@ -477,12 +379,16 @@ class CBP2016_TAGE_SC_L
         int8_t WITHLOOP;    // counter to monitor whether or not loop prediction is beneficial
 
         cbp_hist_t active_hist; // running history always updated accurately
-        // checkpointed history. Can be accesed using the inst-id(seq_no/piece)
-        std::unordered_map<uint64_t/*key*/, cbp_hist_t/*val*/> pred_time_histories;
+        // prediction records of the in-flight conditional branches, in a ring indexed by seq_no (unique per micro-op).
+        // The ring grows when a branch is predicted while the branch in its slot is still in flight.
+        std::vector<cbp_pred_record_t> pred_records;
+        uint64_t pred_records_mask = 0;
 
         CBP2016_TAGE_SC_L (void)
         {
             init_histories (active_hist);
+            pred_records.resize(1024);
+            pred_records_mask = pred_records.size() - 1;
 #ifdef PRINTSIZE
             predictorsize ();
 #endif
@@ -496,6 +402,115 @@ class CBP2016_TAGE_SC_L
         {
         }
 
+        ~CBP2016_TAGE_SC_L()
+        {
+#ifdef LOOPPREDICTOR
+            delete[] ltable;
+#endif
+            delete[] gtable[1];
+            delete[] gtable[BORN];
+            delete[] btable;
+        }
+
+        int predictorsize ()
+        {
+            int STORAGESIZE = 0;
+            int inter = 0;
+
+
+
+            STORAGESIZE +=
+                NBANKHIGH * (1 << (logg[BORN])) * (CWIDTH + UWIDTH + TB[BORN]);
+            STORAGESIZE += NBANKLOW * (1 << (logg[1])) * (CWIDTH + UWIDTH + TB[1]);
+
+            STORAGESIZE += (SIZEUSEALT) * ALTWIDTH;
+            STORAGESIZE += (1 << LOGB) + (1 << (LOGB - HYSTSHIFT));
+            STORAGESIZE += m[NHIST];
+            STORAGESIZE += PHISTWIDTH;
+            STORAGESIZE += 10;      //the TICK counter
+
+            fprintf (stderr, " (TAGE %d) ", STORAGESIZE);
+        #ifdef SC
+        #ifdef LOOPPREDICTOR
+
+            inter = (1 << LOGL) * (2 * WIDTHNBITERLOOP + LOOPTAG + 4 + 4 + 1);
+            fprintf (stderr, " (LOOP %d) ", inter);
+            STORAGESIZE += inter;
+        #endif
+
+            inter += WIDTHRES;
+            inter = WIDTHRESP * ((1 << LOGSIZEUP)); //the update threshold counters
+            inter += 3 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
+            inter += (PERCWIDTH) * 3 * (1 << (LOGBIAS));
+
+            inter +=
+                (GNB - 2) * (1 << (LOGGNB)) * (PERCWIDTH) +
+                (1 << (LOGGNB - 1)) * (2 * PERCWIDTH);
+            inter += Gm[0];     //global histories for SC
+            inter += (PNB - 2) * (1 << (LOGPNB)) * (PERCWIDTH) +
+                (1 << (LOGPNB - 1)) * (2 * PERCWIDTH);
+            //we use phist already counted for these tables
+
+        #ifdef LOCALH
+            inter +=
+                (LNB - 2) * (1 << (LOGLNB)) * (PERCWIDTH) +
+                (1 << (LOGLNB - 1)) * (2 * PERCWIDTH);
+            inter += NLOCAL * Lm[0];
+            inter += EWIDTH * (1 << LOGSIZEUPS);
+        #ifdef LOCALS
+            inter +=
+                (SNB - 2) * (1 << (LOGSNB)) * (PERCWIDTH) +
+                (1 << (LOGSNB - 1)) * (2 * PERCWIDTH);
+            inter += NSECLOCAL * (Sm[0]);
+            inter += EWIDTH * (1 << LOGSIZEUPS);
+
+        #endif
+        #ifdef LOCALT
+            inter +=
+                (TNB - 2) * (1 << (LOGTNB)) * (PERCWIDTH) +
+                (1 << (LOGTNB - 1)) * (2 * PERCWIDTH);
+            inter += NTLOCAL * Tm[0];
+            inter += EWIDTH * (1 << LOGSIZEUPS);
+        #endif
+
+
+
+
+
+
+
+
+
+        #endif
+
+
+
+        #ifdef IMLI
+
+            inter += (1 << (LOGINB - 1)) * PERCWIDTH;
+            inter += Im[0];
+
+            inter += IMNB * (1 << (LOGIMNB - 1)) * PERCWIDTH;
+            inter += 2 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
+            inter += 256 * IMm[0];
+        #endif
+            inter += 2 * CONFWIDTH; //the 2 counters in the choser
+            STORAGESIZE += inter;
+
+
+            fprintf (stderr, " (SC %d) ", inter);
+        #endif
+        #ifdef PRINTSIZE
+            fprintf (stderr, " (TOTAL %d bits %d Kbits) ", STORAGESIZE,
+                    STORAGESIZE / 1024);
+            fprintf (stdout, " (TOTAL %d bits %d Kbits) ", STORAGESIZE,
+                    STORAGESIZE / 1024);
+        #endif
+
+
+            return (STORAGESIZE);
+        }
+
         uint64_t get_unique_inst_id(uint64_t seq_no, uint8_t piece) const
         {
             assert(piece < 16);
@@ -561,9 +576,7 @@ class CBP2016_TAGE_SC_L
 
             for (int i = 1; i <= NHIST; i++)
             {
-                current_hist.ch_i[i].init (m[i], (logg[i]));
-                current_hist.ch_t[0][i].init (current_hist.ch_i[i].OLENGTH, TB[i]);
-                current_hist.ch_t[1][i].init (current_hist.ch_i[i].OLENGTH, TB[i] - 1);
+                current_hist.ch.init (i, m[i], (logg[i]), TB[i]);
 
             }
 
@@ -809,19 +822,19 @@ class CBP2016_TAGE_SC_L
 
         // gindex computes a full hash of PC, ghist and phist
         //int gindex (unsigned int PC, int bank, uint64_t hist, const folded_history * ch_i) const
-        int gindex (unsigned int PC, int bank, uint64_t hist, const tage_index_t& ch_i) const
+        int gindex (unsigned int PC, int bank, uint64_t hist, const tage_folded_history_t& ch) const
         {
             int index;
             int M = (m[bank] > PHISTWIDTH) ? PHISTWIDTH : m[bank];
-            index = PC ^ (PC >> (abs (logg[bank] - bank) + 1)) ^ ch_i[bank].comp ^ F (hist, M, bank);
+            index = PC ^ (PC >> (abs (logg[bank] - bank) + 1)) ^ ch.index (bank) ^ F (hist, M, bank);
 
             return (index & ((1 << (logg[bank])) - 1));
         }
 
         //  tag computation
-        uint16_t gtag (unsigned int PC, int bank, const tage_tag_t& tag_0_array, const tage_tag_t& tag_1_array) const
+        uint16_t gtag (unsigned int PC, int bank, const tage_folded_history_t& ch) const
         {
-            int tag = (PC) ^ tag_0_array[bank].comp ^ (tag_1_array[bank].comp << 1);
+            int tag = (PC) ^ ch.tag0 (bank) ^ (ch.tag1 (bank) << 1);
             return (tag & ((1 << (TB[bank])) - 1));
         }
 
@@ -879,18 +892,19 @@ class CBP2016_TAGE_SC_L
 
 
         //  TAGE PREDICTION: same code at fetch or retire time but the index and tags must recomputed
-        void Tagepred (UINT64 PC, const cbp_hist_t& hist_to_use)
+        // computes the TAGE table addresses and the partial tags from the running history, into the prediction record
+        void Tageindices (UINT64 PC, cbp_pred_record_t& pred_record) const
         {
-            HitBank = 0;
-            AltBank = 0;
+            auto& GI = pred_record.GI;
+            auto& GTAG = pred_record.GTAG;
             for (int i = 1; i <= NHIST; i += 2)
             {
-                GI[i] = gindex (PC, i, hist_to_use.phist, hist_to_use.ch_i);
-                GTAG[i] = gtag (PC, i, hist_to_use.ch_t[0], hist_to_use.ch_t[1]);
+                GI[i] = gindex (PC, i, active_hist.phist, active_hist.ch);
+                GTAG[i] = gtag (PC, i, active_hist.ch);
                 GTAG[i + 1] = GTAG[i];
                 GI[i + 1] = GI[i] ^ (GTAG[i] & ((1 << LOGG) - 1));
             }
-            int T = (PC ^ (hist_to_use.phist & ((1ULL << m[BORN]) - 1))) % NBANKHIGH;
+            int T = (PC ^ (active_hist.phist & ((1ULL << m[BORN]) - 1))) % NBANKHIGH;
             //int T = (PC ^ phist) % NBANKHIGH;
             for (int i = BORN; i <= NHIST; i++)
                 if (NOSKIP[i])
@@ -900,7 +914,7 @@ class CBP2016_TAGE_SC_L
                     T = T % NBANKHIGH;
 
                 }
-            T = (PC ^ (hist_to_use.phist & ((1 << m[1]) - 1))) % NBANKLOW;
+            T = (PC ^ (active_hist.phist & ((1 << m[1]) - 1))) % NBANKLOW;
 
             for (int i = 1; i <= BORN - 1; i++)
                 if (NOSKIP[i])
@@ -910,6 +924,15 @@ class CBP2016_TAGE_SC_L
                     T = T % NBANKLOW;
 
                 }
+        }
+
+        //  TAGE lookup, with the table addresses and the partial tags of the prediction record
+        void Tagepred (UINT64 PC, const cbp_pred_record_t& pred_record)
+        {
+            HitBank = 0;
+            AltBank = 0;
+            std::copy(pred_record.GI.begin(), pred_record.GI.end(), GI);
+            std::copy(pred_record.GTAG.begin(), pred_record.GTAG.end(), GTAG);
             //just do not forget most address are aligned on 4 bytes
             BI = (PC ^ (PC >> 2)) & ((1 << LOGB) - 1);
 
@@ -1006,23 +1029,82 @@ class CBP2016_TAGE_SC_L
 
         bool predict (uint64_t seq_no, uint8_t piece, UINT64 PC)
         {
-            // checkpoint current hist
-            pred_time_histories.emplace(get_unique_inst_id(seq_no, piece), active_hist);
-            const bool pred_taken = predict_using_given_hist(seq_no, piece, PC, active_hist, true/*pred_time_predict*/);
+            // record what is computed from the current hist
+            const cbp_pred_record_t& pred_record = record_prediction(seq_no, piece, PC);
+            const bool pred_taken = predict_using_given_hist(seq_no, piece, PC, pred_record, true/*pred_time_predict*/);
             return pred_taken;
         }
 
-        bool predict_using_given_hist (uint64_t seq_no, uint8_t piece, UINT64 PC, const cbp_hist_t& hist_to_use, const bool pred_time_predict)
+        // Computes the indices and tags of the branch (seq_no, piece) at PC from active_hist, into its prediction record.
+        const cbp_pred_record_t& record_prediction (uint64_t seq_no, uint8_t piece, UINT64 PC)
+        {
+            // a branch predicted again overwrites its record
+            while ((pred_records[seq_no & pred_records_mask].id != INVALID_INST_ID) &&
+                   ((pred_records[seq_no & pred_records_mask].id >> 4) != seq_no))
+            {
+                grow_pred_records();
+            }
+            cbp_pred_record_t& pred_record = pred_records[seq_no & pred_records_mask];
+            pred_record.id = get_unique_inst_id(seq_no, piece);
+            Tageindices (PC, pred_record);
+            Gindices ((PC << 1) + 0, active_hist.GHIST, Gm, GNB, LOGGNB, pred_record.G_index[0].data());
+            Gindices ((PC << 1) + 1, active_hist.GHIST, Gm, GNB, LOGGNB, pred_record.G_index[1].data());
+            Gindices (PC, active_hist.phist, Pm, PNB, LOGPNB, pred_record.P_index.data());
+#ifdef LOCALH
+            Gindices (PC, active_hist.L_shist[get_local_index(PC)], Lm, LNB, LOGLNB, pred_record.L_index.data());
+#ifdef LOCALS
+            Gindices (PC, active_hist.S_slhist[get_second_local_index(PC)], Sm, SNB, LOGSNB, pred_record.S_index.data());
+#endif
+#ifdef LOCALT
+            Gindices (PC, active_hist.T_slhist[get_third_local_index(PC)], Tm, TNB, LOGTNB, pred_record.T_index.data());
+#endif
+#endif
+#ifdef IMLI
+            Gindices (PC, active_hist.IMHIST[active_hist.IMLIcount], IMm, IMNB, LOGIMNB, pred_record.IM_index.data());
+            Gindices (PC, active_hist.IMLIcount, Im, INB, LOGINB, pred_record.I_index.data());
+#endif
+            return pred_record;
+        }
+
+        // Doubles the record ring until the in-flight branches map to distinct slots.
+        void grow_pred_records ()
+        {
+            uint64_t size = pred_records.size();
+            bool collision = true;
+            std::vector<cbp_pred_record_t> grown;
+            while (collision)
+            {
+                size <<= 1;
+                grown.assign(size, cbp_pred_record_t());
+                collision = false;
+                for (const auto& pred_record : pred_records)
+                {
+                    if (pred_record.id == INVALID_INST_ID)
+                        continue;
+                    auto& slot = grown[(pred_record.id >> 4) & (size - 1)];
+                    if (slot.id != INVALID_INST_ID)
+                    {
+                        collision = true;
+                        break;
+                    }
+                    slot = pred_record;
+                }
+            }
+            pred_records.swap(grown);
+            pred_records_mask = size - 1;
+        }
+
+        bool predict_using_given_hist (uint64_t seq_no, uint8_t piece, UINT64 PC, const cbp_pred_record_t& pred_record, const bool pred_time_predict)
         {
             // computes the TAGE table addresses and the partial tags
-            Tagepred (PC, hist_to_use);
+            Tagepred (PC, pred_record);
             bool pred_taken = tage_pred;
 #ifndef SC
             return (tage_pred);
 #endif
 
 #ifdef LOOPPREDICTOR
-            predloop = getloop (PC, hist_to_use);   // loop prediction
+            predloop = getloop (PC, pred_record);   // loop prediction
             pred_taken = ((WITHLOOP >= 0) && (LVALID)) ? predloop : pred_taken;
 #endif
             pred_inter = pred_taken;
@@ -1043,21 +1125,21 @@ class CBP2016_TAGE_SC_L
             LSUM = (1 + (WB[INDUPDS] >= 0)) * LSUM;
 #endif
             //integrate the GEHL predictions
-            LSUM += Gpredict ((PC << 1) + pred_inter, hist_to_use.GHIST, Gm, GGEHL, GNB, LOGGNB, WG);
-            LSUM += Gpredict (PC, hist_to_use.phist, Pm, PGEHL, PNB, LOGPNB, WP);
+            LSUM += Gpredict ((PC << 1) + pred_inter, pred_record.G_index[pred_inter].data(), GGEHL, GNB, WG);
+            LSUM += Gpredict (PC, pred_record.P_index.data(), PGEHL, PNB, WP);
 #ifdef LOCALH
-            LSUM += Gpredict (PC, hist_to_use.L_shist[get_local_index(PC)], Lm, LGEHL, LNB, LOGLNB, WL);
+            LSUM += Gpredict (PC, pred_record.L_index.data(), LGEHL, LNB, WL);
 #ifdef LOCALS
-            LSUM += Gpredict (PC, hist_to_use.S_slhist[get_second_local_index(PC)], Sm, SGEHL, SNB, LOGSNB, WS);
+            LSUM += Gpredict (PC, pred_record.S_index.data(), SGEHL, SNB, WS);
 #endif
 #ifdef LOCALT
-            LSUM += Gpredict (PC, hist_to_use.T_slhist[get_third_local_index(PC)], Tm, TGEHL, TNB, LOGTNB, WT);
+            LSUM += Gpredict (PC, pred_record.T_index.data(), TGEHL, TNB, WT);
 #endif
 #endif
 
 #ifdef IMLI
-            LSUM += Gpredict (PC, hist_to_use.IMHIST[(hist_to_use.IMLIcount)], IMm, IMGEHL, IMNB, LOGIMNB, WIM);
-            LSUM += Gpredict (PC, hist_to_use.IMLIcount, Im, IGEHL, INB, LOGINB, WI);
+            LSUM += Gpredict (PC, pred_record.IM_index.data(), IMGEHL, IMNB, WIM);
+            LSUM += Gpredict (PC, pred_record.I_index.data(), IGEHL, INB, WI);
 #endif
             bool SCPRED = (LSUM >= 0);
             //just  an heuristic if the respective contribution of component groups can be multiplied by 2 or not
@@ -1123,10 +1205,6 @@ class CBP2016_TAGE_SC_L
             auto& X = active_hist.phist;
             auto& Y = active_hist.ptghist;
 
-            auto& H = active_hist.ch_i;
-            auto& G = active_hist.ch_t[0];
-            auto& J = active_hist.ch_t[1];
-
             //special treatment for indirect  branchs;
             int maxt = 2;
             if (brtype & 1)   // conditional
@@ -1192,12 +1270,7 @@ class CBP2016_TAGE_SC_L
 
 
                 // updates to folded histories
-                for (int i = 1; i <= NHIST; i++)
-                {
-                    H[i].update (active_hist.ghist, Y);
-                    G[i].update (active_hist.ghist, Y);
-                    J[i].update (active_hist.ghist, Y);
-                }
+                active_hist.ch.update (active_hist.ghist.data(), Y, HISTBUFFERLENGTH);
             }
 
             X = (X & ((1<<PHISTWIDTH)-1));
@@ -1209,20 +1282,20 @@ class CBP2016_TAGE_SC_L
         //void update (UINT64 PC, int brtype, bool resolveDir, bool predDir, UINT64 nextPC)
         void update (uint64_t seq_no, uint8_t piece, UINT64 PC, bool resolveDir, bool predDir, UINT64 nextPC)
         {
-            const auto pred_hist_key = get_unique_inst_id(seq_no, piece);
-            const auto& pred_time_history = pred_time_histories.at(pred_hist_key);
-            const bool pred_taken = predict_using_given_hist(seq_no, piece, PC, pred_time_history, false/*pred_time_predict*/);
+            auto& pred_record = pred_records[seq_no & pred_records_mask];
+            assert((pred_record.id == get_unique_inst_id(seq_no, piece)) && "Branch updated without a prediction record");
+            const bool pred_taken = predict_using_given_hist(seq_no, piece, PC, pred_record, false/*pred_time_predict*/);
             //if(pred_taken != predDir)
             //{
             //    std::cout<<"id:"<<seq_no<<" PC:0x"<<std::hex<<PC<<std::dec<<" resolveDir:"<<resolveDir<<" pred_dir_at_pred:"<<predDir<<" pred_dir_at_update:"<<pred_taken<<std::endl;
             //    assert(false);
             //} 
-            // remove checkpointed hist
-            update(PC, resolveDir, pred_taken, nextPC, pred_time_history);
-            pred_time_histories.erase(pred_hist_key);
+            update(PC, resolveDir, pred_taken, nextPC, pred_record);
+            // free the prediction record
+            pred_record.id = INVALID_INST_ID;
         }
 
-        void update (UINT64 PC, bool resolveDir, bool pred_taken, UINT64 nextPC, const cbp_hist_t& hist_to_use)
+        void update (UINT64 PC, bool resolveDir, bool pred_taken, UINT64 nextPC, const cbp_pred_record_t& pred_record)
         {
 #ifdef SC
 #ifdef LOOPPREDICTOR
@@ -1231,7 +1304,7 @@ class CBP2016_TAGE_SC_L
                 if (pred_taken != predloop)
                     ctrupdate (WITHLOOP, (predloop == resolveDir), 7);
             }
-            loopupdate (PC, resolveDir, (pred_taken != resolveDir), hist_to_use);
+            loopupdate (PC, resolveDir, (pred_taken != resolveDir), pred_record);
 #endif
 
             bool SCPRED = (LSUM >= 0);
@@ -1304,27 +1377,27 @@ class CBP2016_TAGE_SC_L
                 ctrupdate (BiasSK[get_biassk_index(PC)], resolveDir, PERCWIDTH);
                 ctrupdate (BiasBank[get_biasbank_index(PC)], resolveDir, PERCWIDTH);
                 Gupdate ((PC << 1) + pred_inter, resolveDir,
-                        hist_to_use.GHIST, Gm, GGEHL, GNB, LOGGNB, WG);
-                Gupdate (PC, resolveDir, hist_to_use.phist, Pm, PGEHL, PNB, LOGPNB, WP);
+                        pred_record.G_index[pred_inter].data(), GGEHL, GNB, WG);
+                Gupdate (PC, resolveDir, pred_record.P_index.data(), PGEHL, PNB, WP);
 #ifdef LOCALH
-                Gupdate (PC, resolveDir, hist_to_use.L_shist[get_local_index(PC)], Lm, LGEHL, LNB, LOGLNB,
+                Gupdate (PC, resolveDir, pred_record.L_index.data(), LGEHL, LNB,
                         WL);
 #ifdef LOCALS
-                Gupdate (PC, resolveDir, hist_to_use.S_slhist[get_second_local_index(PC)], Sm,
-                        SGEHL, SNB, LOGSNB, WS);
+                Gupdate (PC, resolveDir, pred_record.S_index.data(),
+                        SGEHL, SNB, WS);
 #endif
 #ifdef LOCALT
 
-                Gupdate (PC, resolveDir, hist_to_use.T_slhist[get_third_local_index(PC)], Tm, TGEHL, TNB, LOGTNB,
+                Gupdate (PC, resolveDir, pred_record.T_index.data(), TGEHL, TNB,
                         WT);
 #endif
 #endif
 
 
 #ifdef IMLI
-                Gupdate (PC, resolveDir, hist_to_use.IMHIST[(hist_to_use.IMLIcount)], IMm, IMGEHL, IMNB,
-                        LOGIMNB, WIM);
-                Gupdate (PC, resolveDir, hist_to_use.IMLIcount, Im, IGEHL, INB, LOGINB, WI);
+                Gupdate (PC, resolveDir, pred_record.IM_index.data(), IMGEHL, IMNB,
+                        WIM);
+                Gupdate (PC, resolveDir, pred_record.I_index.data(), IGEHL, INB, WI);
 #endif
 
 
@@ -1542,15 +1615,22 @@ class CBP2016_TAGE_SC_L
         }//END PREDICTOR UPDATE
 
 #define GINDEX (((uint64_t) PC) ^ bhist ^ (bhist >> (8 - i)) ^ (bhist >> (16 - 2 * i)) ^ (bhist >> (24 - 3 * i)) ^ (bhist >> (32 - 3 * i)) ^ (bhist >> (40 - 4 * i))) & ((1 << (logs - (i >= (NBR - 2)))) - 1)
-        int Gpredict (UINT64 PC, uint64_t BHIST, int *length, int8_t ** tab, int NBR, int logs, int8_t * W)
+        // indices of the NBR tables of a GEHL component, from the PC and the component's history
+        void Gindices (UINT64 PC, uint64_t BHIST, int *length, int NBR, int logs, uint16_t * indices) const
         {
-            int PERCSUM = 0;
             for (int i = 0; i < NBR; i++)
             {
                 uint64_t bhist = BHIST & ((uint64_t) ((1ULL << length[i]) - 1));
-                uint64_t index = GINDEX;
+                indices[i] = GINDEX;
+            }
+        }
 
-                int8_t ctr = tab[i][index];
+        int Gpredict (UINT64 PC, const uint16_t * indices, int8_t ** tab, int NBR, int8_t * W)
+        {
+            int PERCSUM = 0;
+            for (int i = 0; i < NBR; i++)
+            {
+                int8_t ctr = tab[i][indices[i]];
 
                 PERCSUM += (2 * ctr + 1);
             }
@@ -1559,16 +1639,15 @@ class CBP2016_TAGE_SC_L
 #endif
             return ((PERCSUM));
         }
-        void Gupdate (UINT64 PC, bool taken, uint64_t BHIST, int *length,
-                int8_t ** tab, int NBR, int logs, int8_t * W)
+        void Gupdate (UINT64 PC, bool taken, const uint16_t * indices,
+                int8_t ** tab, int NBR, int8_t * W)
         {
 
             int PERCSUM = 0;
 
             for (int i = 0; i < NBR; i++)
             {
-                uint64_t bhist = BHIST & ((uint64_t) ((1ULL << length[i]) - 1));
-                uint64_t index = GINDEX;
+                const uint64_t index = indices[i];
 
                 PERCSUM += (2 * tab[i][index] + 1);
                 ctrupdate (tab[i][index], taken, PERCWIDTH);
@@ -1595,7 +1674,7 @@ class CBP2016_TAGE_SC_L
         //skewed associative 4-way
         //At fetch time: speculative
 #define CONFLOOP 15
-        bool getloop (UINT64 PC, const cbp_hist_t& hist_to_use)
+        bool getloop (UINT64 PC, const cbp_pred_record_t& pred_record)
         {
             LHIT = -1;
 
@@ -1629,7 +1708,7 @@ class CBP2016_TAGE_SC_L
 
 
 
-        void loopupdate (UINT64 PC, bool Taken, bool ALLOC, const cbp_hist_t& hist_to_use)
+        void loopupdate (UINT64 PC, bool Taken, bool ALLOC, const cbp_pred_record_t& pred_record)
         {
             if (LHIT >= 0)
             {
@@ -1734,4 +1813,3 @@ class CBP2016_TAGE_SC_L
 #undef UINT64
 
 #endif
-static CBP2016_TAGE_SC_L cbp2016_tage_sc_l;
@@ -14,137 +14,163 @@
   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-// This file provides a sample predictor integration based on the interface provided.
+// This file integrates the CBP2016 TAGE-SC-L predictor (cbp2016_tage_sc_l.h), registered as "tage_sc_l".
 
 #include <cassert>
 #include "lib/sim_common_structs.h"
+#include "cbp.h"
 #include "cbp2016_tage_sc_l.h"
 
-//
-// beginCondDirPredictor()
-//
-// This function is called by the simulator before the start of simulation.
-// It can be used for arbitrary initialization steps for the contestant's code.
-//
-void beginCondDirPredictor()
+class TageScLPredictor : public CondDirPredictor
 {
-    cbp2016_tage_sc_l.setup();
-}
-
-//
-// get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
-//
-// This function is called by the simulator for predicting conditional branches.
-// input values are unique identifying ids(seq_no, piece) and PC of the branch.
-// return value is the predicted direction.
-//
-bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
-{
-    const bool tage_sc_l_pred = cbp2016_tage_sc_l.predict(seq_no, piece, pc);
-    return tage_sc_l_pred;
-}
-
-//
-// spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
-//
-// This function is called by the simulator for updating the history vectors and any state that needs to be updated speculatively.
-// The function is called for all the branches (not just conditional branches). To faciliate accurate history updates, spec_update is called right
-// after a prediction is made.
-// input values are unique identifying ids(seq_no, piece), PC of the instruction, instruction class, predicted/resolve direction and the next_pc
-//
-void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
-{
-    assert(is_br(inst_class));
-    int br_type = 0;
-    switch (inst_class)
+public:
+    //
+    // beginCondDirPredictor()
+    //
+    // This function is called by the simulator before the start of simulation.
+    // It can be used for arbitrary initialization steps for the contestant's code.
+    //
+    void beginCondDirPredictor() override
     {
-    case InstClass::condBranchInstClass:
-        br_type = 1;
-        break;
-    case InstClass::uncondDirectBranchInstClass:
-        br_type = 0;
-        break;
-    case InstClass::uncondIndirectBranchInstClass:
-        br_type = 2;
-        break;
-    case InstClass::callDirectInstClass:
-        br_type = 0;
-        break;
-    case InstClass::callIndirectInstClass:
-        br_type = 2;
-        break;
-    case InstClass::ReturnInstClass:
-        br_type = 2;
-        break;
-    default:
-        assert(false);
+        cbp2016_tage_sc_l.setup();
     }
 
-    if (inst_class == InstClass::condBranchInstClass)
+    //
+    // get_notify_subscription()
+    //
+    // This function is called by the simulator right after beginCondDirPredictor().
+    // It returns the instruction classes the notify_instr_* functions below are called for.
+    //
+    // The sample predictor only leverages execute information, of branches.
+    NotifySubscription get_notify_subscription() const override
     {
-        cbp2016_tage_sc_l.history_update(seq_no, piece, pc, br_type, resolve_dir, next_pc);
+        NotifySubscription subscription;
+        subscription.decode = NO_INST_CLASSES;
+        subscription.execute = BRANCH_INST_CLASSES;
+        subscription.commit = NO_INST_CLASSES;
+        return subscription;
     }
-    else
+
+    //
+    // get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
+    //
+    // This function is called by the simulator for predicting conditional branches.
+    // input values are unique identifying ids(seq_no, piece) and PC of the branch.
+    // return value is the predicted direction.
+    //
+    bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle) override
     {
-        cbp2016_tage_sc_l.TrackOtherInst(pc, br_type, resolve_dir, next_pc);
+        const bool tage_sc_l_pred = cbp2016_tage_sc_l.predict(seq_no, piece, pc);
+        return tage_sc_l_pred;
     }
-}
-
-//
-// notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle)
-//
-// This function is called when any instructions(not just branches) gets decoded.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, decode info and cycle are also provided as inputs
-//
-// For the sample predictor implementation, we do not leverage decode information
-void notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo &_decode_info, const uint64_t decode_cycle)
-{
-}
-
-//
-// notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle)
-//
-// This function is called when any instructions(not just branches) gets executed.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
-//
-// For conditional branches, we use this information to update the predictor.
-// At the moment, we do not consider updating any other structure, but the contestants are allowed to  update any other predictor state.
-void notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t execute_cycle)
-{
-    const bool is_branch = is_br(_exec_info.dec_info.insn_class);
-    if (is_branch)
+
+    //
+    // spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
+    //
+    // This function is called by the simulator for updating the history vectors and any state that needs to be updated speculatively.
+    // The function is called for all the branches (not just conditional branches). To faciliate accurate history updates, spec_update is called right
+    // after a prediction is made.
+    // input values are unique identifying ids(seq_no, piece), PC of the instruction, instruction class, predicted/resolve direction and the next_pc
+    //
+    void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc) override
     {
-        if (is_cond_br(_exec_info.dec_info.insn_class))
+        assert(is_br(inst_class));
+        int br_type = 0;
+        switch (inst_class)
+        {
+        case InstClass::condBranchInstClass:
+            br_type = 1;
+            break;
+        case InstClass::uncondDirectBranchInstClass:
+            br_type = 0;
+            break;
+        case InstClass::uncondIndirectBranchInstClass:
+            br_type = 2;
+            break;
+        case InstClass::callDirectInstClass:
+            br_type = 0;
+            break;
+        case InstClass::callIndirectInstClass:
+            br_type = 2;
+            break;
+        case InstClass::ReturnInstClass:
+            br_type = 2;
+            break;
+        default:
+            assert(false);
+        }
+
+        if (inst_class == InstClass::condBranchInstClass)
         {
-            const bool _resolve_dir = _exec_info.taken.value();
-            const uint64_t _next_pc = _exec_info.next_pc;
-            cbp2016_tage_sc_l.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
+            cbp2016_tage_sc_l.history_update(seq_no, piece, pc, br_type, resolve_dir, next_pc);
         }
         else
         {
-            assert(pred_dir);
+            cbp2016_tage_sc_l.TrackOtherInst(pc, br_type, resolve_dir, next_pc);
         }
     }
-}
-
-//
-// notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle)
-//
-// This function is called when any instructions(not just branches) gets committed.
-// Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
-//
-// For the sample predictor implementation, we do not leverage commit information
-void notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t commit_cycle)
-{
-}
-
-//
-// endCondDirPredictor()
-//
-// This function is called by the simulator at the end of simulation.
-// It can be used by the contestant to print out other contestant-specific measurements.
-//
-void endCondDirPredictor()
-{
-    cbp2016_tage_sc_l.terminate();
-}
+
+    //
+    // notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo& _decode_info, const uint64_t decode_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets decoded.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, decode info and cycle are also provided as inputs
+    //
+    // For the sample predictor implementation, we do not leverage decode information
+    void notify_instr_decode(uint64_t seq_no, uint8_t piece, uint64_t pc, const DecodeInfo &_decode_info, const uint64_t decode_cycle) override
+    {
+    }
+
+    //
+    // notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t execute_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets executed.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+    //
+    // For conditional branches, we use this information to update the predictor.
+    // At the moment, we do not consider updating any other structure, but the contestants are allowed to  update any other predictor state.
+    void notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t execute_cycle) override
+    {
+        const bool is_branch = is_br(_exec_info.dec_info.insn_class);
+        if (is_branch)
+        {
+            if (is_cond_br(_exec_info.dec_info.insn_class))
+            {
+                const bool _resolve_dir = _exec_info.taken.value();
+                const uint64_t _next_pc = _exec_info.next_pc;
+                cbp2016_tage_sc_l.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
+            }
+            else
+            {
+                assert(pred_dir);
+            }
+        }
+    }
+
+    //
+    // notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo& _exec_info, const uint64_t commit_cycle)
+    //
+    // This function is called when any instructions(not just branches) gets committed.
+    // Along with the unique identifying ids(seq_no, piece), PC of the instruction, execute info and cycle are also provided as inputs
+    //
+    // For the sample predictor implementation, we do not leverage commit information
+    void notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool pred_dir, const ExecuteInfo &_exec_info, const uint64_t commit_cycle) override
+    {
+    }
+
+    //
+    // endCondDirPredictor()
+    //
+    // This function is called by the simulator at the end of simulation.
+    // It can be used by the contestant to print out other contestant-specific measurements.
+    //
+    void endCondDirPredictor() override
+    {
+        cbp2016_tage_sc_l.terminate();
+    }
+
+private:
+    CBP2016_TAGE_SC_L cbp2016_tage_sc_l;
+};
+
+static const bool tage_sc_l_registered = registerCondDirPredictor("tage_sc_l", []() -> CondDirPredictor * { return new TageScLPredictor(); });
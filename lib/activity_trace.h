@@ -0,0 +1,211 @@
+// Activity trace of the timing model (.cbpa)
+//
+// uarchsim_t records the micro-ops it fetches, executes and retires as fixed-size binary events, only when
+// tracing is on (cbp -L) and only for the cycles asked for. Events are buffered in a ring and written out when it
+// fills up and at the end of the run. Nothing is formatted during the simulation: tools/cbp_activity.cc renders
+// a trace as text.
+//
+// Building with -DACTIVITY_TRACE=0 compiles the recording out altogether.
+//
+// File Format :
+// Header                   - 8 bytes magic + 4 bytes version + 4 bytes sizeof(activity_event_t)
+// Events                   - activity_event_t, in recording order
+//
+// The events are written as laid out in memory: a trace is read back by a decoder built for the same host.
+//
+// Include after trace_reader.h (db_t).
+
+#ifndef _ACTIVITY_TRACE_H
+#define _ACTIVITY_TRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <vector>
+#include "sim_common_structs.h"
+#include "instr_window.h"
+
+#ifndef ACTIVITY_TRACE
+#define ACTIVITY_TRACE 1
+#endif
+
+static constexpr char ACTIVITY_TRACE_MAGIC[8] = {'C', 'B', 'P', 'A', 'C', 'T', '\0', '\0'};
+static constexpr uint32_t ACTIVITY_TRACE_VERSION = 1;
+
+#define ACTIVITY_TRACE_RING_EVENTS 4096
+
+enum class activity_kind_t : uint8_t
+{
+   Fetched,
+   Executed,
+   Retired,
+};
+
+struct activity_event_t
+{
+   uint64_t cycle;
+   activity_kind_t kind;
+   uint8_t piece;
+   InstClass insn_class;
+   bool taken_populated;
+   bool taken;
+   uint64_t seq_no;
+   uint64_t PC;
+   uint64_t fetch_cycle;
+   uint64_t decode_cycle;
+   uint64_t exec_cycle;
+   uint64_t retire_cycle;
+   db_t inst;                // Fetched events only
+
+   // Same text as the window entries used to be printed with.
+   friend std::ostream& operator<<(std::ostream& os, const activity_event_t& e)
+   {
+      static const char *kinds[] = {"Fetched", "Executed", "Retired"};
+      os<<e.cycle<<"::"<<kinds[static_cast<uint8_t>(e.kind)]<<":";
+      os<<"{";
+      os<<" ["<<e.seq_no<<","<<(uint64_t)e.piece<<"]";
+      os<<" PC:0x"<<std::hex<<e.PC<<std::dec;
+      os<<" Class:"<<cInfo[static_cast<uint8_t>(e.insn_class)];
+      os<<" TakenPopulated:"<<e.taken_populated;
+      os<<" TakenVal:"<<e.taken;
+      os<<" fetch_cycle:"<<e.fetch_cycle;
+      os<<" decode_cycle:"<<e.decode_cycle;
+      os<<" exec_cycle:"<<e.exec_cycle;
+      os<<" retire_cycle:"<<e.retire_cycle;
+      os<<"}";
+      if (e.kind == activity_kind_t::Fetched)
+         os<<" Inst:"<<e.inst;
+      return os;
+   }
+};
+
+class activity_trace_t
+{
+private:
+   FILE *fp;
+   uint64_t start_cycle;
+   uint64_t end_cycle;
+   std::vector<activity_event_t> ring;
+   uint64_t num_events;     // events in the ring, not yet written
+
+public:
+   activity_trace_t()
+      : fp(nullptr), start_cycle(0), end_cycle(0), num_events(0)
+   {
+   }
+
+   ~activity_trace_t()
+   {
+      close();
+   }
+
+   // Starts recording the events of cycles start_cycle to end_cycle into file name.
+   void open(const char *name, uint64_t _start_cycle, uint64_t _end_cycle)
+   {
+      close();
+      fp = fopen(name, "wb");
+      if (fp == nullptr)
+      {
+         fprintf(stderr, "Could not open activity trace %s\n", name);
+         exit(-1);
+      }
+      const uint32_t event_size = sizeof(activity_event_t);
+      fwrite(ACTIVITY_TRACE_MAGIC, 1, sizeof(ACTIVITY_TRACE_MAGIC), fp);
+      fwrite(&ACTIVITY_TRACE_VERSION, sizeof(ACTIVITY_TRACE_VERSION), 1, fp);
+      fwrite(&event_size, sizeof(event_size), 1, fp);
+      start_cycle = _start_cycle;
+      end_cycle = _end_cycle;
+      ring.resize(ACTIVITY_TRACE_RING_EVENTS);
+      num_events = 0;
+   }
+
+   void flush()
+   {
+      if (fp == nullptr)
+         return;
+      fwrite(ring.data(), sizeof(activity_event_t), num_events, fp);
+      fflush(fp);
+      num_events = 0;
+   }
+
+   void close()
+   {
+      if (fp == nullptr)
+         return;
+      flush();
+      fclose(fp);
+      fp = nullptr;
+   }
+
+   // True if the events of cycle are recorded. The only cost of tracing when it is off.
+   bool active(uint64_t cycle) const
+   {
+      return ACTIVITY_TRACE && (fp != nullptr) && (cycle >= start_cycle) && (cycle <= end_cycle);
+   }
+
+   // Records the event of a window entry, at cycle. inst is only read for Fetched events.
+   void record(activity_kind_t kind, uint64_t cycle, const window_t &entry, const ExecuteInfo &exec_info, const db_t *inst = nullptr)
+   {
+      if (!active(cycle))
+         return;
+      activity_event_t &e = ring[num_events];
+      memset(&e, 0, sizeof(e));
+      e.cycle = cycle;
+      e.kind = kind;
+      e.piece = entry.piece;
+      e.insn_class = exec_info.dec_info.insn_class;
+      e.taken_populated = exec_info.taken.has_value();
+      e.taken = exec_info.taken.value_or(false);
+      e.seq_no = entry.seq_no;
+      e.PC = entry.PC;
+      e.fetch_cycle = entry.fetch_cycle;
+      e.decode_cycle = entry.decode_cycle;
+      e.exec_cycle = entry.exec_cycle;
+      e.retire_cycle = entry.retire_cycle;
+      if (inst != nullptr)
+         e.inst = *inst;
+      if (++num_events == ring.size())
+         flush();
+   }
+};
+
+// Reads back the events of an activity trace.
+class activity_trace_reader
+{
+private:
+   FILE *fp;
+
+public:
+   activity_trace_reader(const char *name)
+   {
+      fp = fopen(name, "rb");
+      if (fp == nullptr)
+      {
+         fprintf(stderr, "Could not open activity trace %s\n", name);
+         exit(-1);
+      }
+      char magic[sizeof(ACTIVITY_TRACE_MAGIC)];
+      uint32_t version = 0, event_size = 0;
+      if ((fread(magic, 1, sizeof(magic), fp) != sizeof(magic)) || memcmp(magic, ACTIVITY_TRACE_MAGIC, sizeof(magic)) ||
+          (fread(&version, sizeof(version), 1, fp) != 1) || (version != ACTIVITY_TRACE_VERSION) ||
+          (fread(&event_size, sizeof(event_size), 1, fp) != 1) || (event_size != sizeof(activity_event_t)))
+      {
+         fprintf(stderr, "%s is not an activity trace (or was written by a different build)\n", name);
+         exit(-1);
+      }
+   }
+
+   ~activity_trace_reader()
+   {
+      fclose(fp);
+   }
+
+   bool next(activity_event_t &e)
+   {
+      return fread(&e, sizeof(e), 1, fp) == 1;
+   }
+};
+
+#endif
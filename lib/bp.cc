@@ -33,10 +33,10 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "cbp.h"
 #include "parameters.h"
 
-#include "parameters.h"
-
-bp_t::bp_t()
+bp_t::bp_t(CondDirPredictor *cond_pred)
+    : cond_pred(cond_pred)
 {
+   assert(cond_pred);
    if (!PERFECT_INDIRECT_PRED)
    {
       ITTAGE = new IPREDICTOR();
@@ -87,7 +87,7 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
 
       // Make prediction.
       // pred_taken= TAGESCL->GetPrediction (pc);
-      pred_taken = get_cond_dir_prediction(seq_no, piece, pc, pred_cycle);
+      pred_taken = cond_pred->get_cond_dir_prediction(seq_no, piece, pc, pred_cycle);
 
       // Determine if mispredicted or not.
       misp = (pred_taken != taken);
@@ -110,7 +110,7 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
       // spec_update(seq_no, piece, pc, inst_class, taken, pred_taken, next_pc);
       // temp_predictor_update_hook(seq_no, piece, pc, taken,pred_taken, next_pc);
       //  OOO Update Option
-      spec_update(seq_no, piece, pc, inst_class, taken, pred_taken, next_pc);
+      cond_pred->spec_update(seq_no, piece, pc, inst_class, taken, pred_taken, next_pc);
       // Update measurements.
       meas_conddir_n_per_epoch.back()++;
       meas_conddir_m_per_epoch.back() += misp;
@@ -127,7 +127,7 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
       /* A. Seznec: update branch  histories for TAGE-SC-L and ITTAGE */
       // TAGESCL->TrackOtherInst(pc , 0,  true,next_pc);
       // TrackOtherInst(pc , 0,  true,next_pc);
-      spec_update(seq_no, piece, pc, inst_class, true /*taken*/, true /*pred_taken*/, next_pc);
+      cond_pred->spec_update(seq_no, piece, pc, inst_class, true /*taken*/, true /*pred_taken*/, next_pc);
       if (!PERFECT_INDIRECT_PRED)
       {
          ITTAGE->TrackOtherInst(pc, next_pc);
@@ -163,7 +163,7 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
          meas_jumpret_m_per_epoch.back() += is_ret && misp;
       }
 
-      spec_update(seq_no, piece, pc, inst_class, true /*taken*/, true /*pred_taken*/, next_pc);
+      cond_pred->spec_update(seq_no, piece, pc, inst_class, true /*taken*/, true /*pred_taken*/, next_pc);
       /* A. Seznec: update history for TAGE-SC-L */
       // TAGESCL->TrackOtherInst(pc , 2,  true,next_pc);
       // TrackOtherInst(pc , 2,  true,next_pc);
@@ -200,6 +200,11 @@ void bp_t::notify_begin_new_epoch()
    meas_cycles_on_wrong_path_per_epoch.emplace_back(0); // cycles_on_wrong_path
 }
 
+void bp_t::account_notctrl(uint64_t num_uops)
+{
+   meas_notctrl_n_per_epoch.back() += num_uops;
+}
+
 void bp_t::update_cycles_on_wrong_path(const uint64_t cycles_on_wrong_path)
 {
    meas_cycles_on_wrong_path_per_epoch.back() += cycles_on_wrong_path;
@@ -239,6 +244,26 @@ void bp_t::output()
    printf("------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
 }
 
+// Direct conditional branch measurements of the last epochs that hold more than target_instr_count instructions
+// (all epochs if there are not enough).
+bp_t::conddir_meas_t bp_t::measure_conddir(const std::vector<uint64_t> &num_insts_per_epoch, const std::vector<uint64_t> &num_cycles_per_epoch, const uint64_t target_instr_count) const
+{
+   conddir_meas_t meas = {};
+   for (int epoch_index = num_insts_per_epoch.size() - 1; epoch_index >= 0; epoch_index--)
+   {
+      meas.instr += num_insts_per_epoch.at(epoch_index);
+      meas.cycles += num_cycles_per_epoch.at(epoch_index);
+      meas.br += meas_conddir_n_per_epoch.at(epoch_index);
+      meas.br_mispred += meas_conddir_m_per_epoch.at(epoch_index);
+      meas.cycles_on_wrong_path += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
+      if (meas.instr > target_instr_count)
+      {
+         break;
+      }
+   }
+   return meas;
+}
+
 void bp_t::output_periodic_info(const std::vector<uint64_t> &num_insts_per_epoch, const std::vector<uint64_t> &num_cycles_per_epoch)
 {
    assert(num_insts_per_epoch.size() == num_cycles_per_epoch.size());
@@ -247,23 +272,12 @@ void bp_t::output_periodic_info(const std::vector<uint64_t> &num_insts_per_epoch
       const uint64_t target_instr_count = 10000000;
       printf("\n------------------------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (Last 10M instructions)-----------------------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for (int epoch_index = num_insts_per_epoch.size() - 1; epoch_index >= 0; epoch_index--)
-      {
-         my_instr_count += num_insts_per_epoch.at(epoch_index);
-         my_cycle_count += num_cycles_per_epoch.at(epoch_index);
-         my_br_count += meas_conddir_n_per_epoch.at(epoch_index);
-         my_br_mispred_count += meas_conddir_m_per_epoch.at(epoch_index);
-         my_wpc_count += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-         if (my_instr_count > target_instr_count)
-         {
-            break;
-         }
-      }
+      const conddir_meas_t meas = measure_conddir(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = meas.instr;
+      const uint64_t my_cycle_count = meas.cycles;
+      const uint64_t my_br_count = meas.br;
+      const uint64_t my_br_mispred_count = meas.br_mispred;
+      const uint64_t my_wpc_count = meas.cycles_on_wrong_path;
       const double cyc_wp_avg = (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count / (double)my_br_mispred_count;
       const double cyc_wp_pki = (double)my_wpc_count * 1000 / (double)my_instr_count;
       printf("%12ld %12ld %8.4f %10ld %10ld %8.4lf %12.4lf %8.4lf%% %8.4lf %10ld %10.4lf %10.4lf\n", my_instr_count, my_cycle_count, (double)my_instr_count / (double)my_cycle_count, my_br_count, my_br_mispred_count, (double)(my_br_count) / (double)(my_cycle_count), (double)(my_br_mispred_count) / (double)(my_cycle_count), 100.0 * ((double)(my_br_mispred_count) / (double)(my_br_count)), 1000.0 * ((double)(my_br_mispred_count) / (double)(my_instr_count)), my_wpc_count, cyc_wp_avg, cyc_wp_pki);
@@ -274,23 +288,12 @@ void bp_t::output_periodic_info(const std::vector<uint64_t> &num_insts_per_epoch
       const uint64_t target_instr_count = 25000000;
       printf("\n------------------------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (Last 25M instructions)-----------------------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for (int epoch_index = num_insts_per_epoch.size() - 1; epoch_index >= 0; epoch_index--)
-      {
-         my_instr_count += num_insts_per_epoch.at(epoch_index);
-         my_cycle_count += num_cycles_per_epoch.at(epoch_index);
-         my_br_count += meas_conddir_n_per_epoch.at(epoch_index);
-         my_br_mispred_count += meas_conddir_m_per_epoch.at(epoch_index);
-         my_wpc_count += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-         if (my_instr_count > target_instr_count)
-         {
-            break;
-         }
-      }
+      const conddir_meas_t meas = measure_conddir(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = meas.instr;
+      const uint64_t my_cycle_count = meas.cycles;
+      const uint64_t my_br_count = meas.br;
+      const uint64_t my_br_mispred_count = meas.br_mispred;
+      const uint64_t my_wpc_count = meas.cycles_on_wrong_path;
       const double cyc_wp_avg = (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count / (double)my_br_mispred_count;
       const double cyc_wp_pki = (double)my_wpc_count * 1000 / (double)my_instr_count;
       printf("%12ld %12ld %8.4f %10ld %10ld %8.4lf %12.4lf %8.4lf%% %8.4lf %10ld %10.4lf %10.4lf\n", my_instr_count, my_cycle_count, (double)my_instr_count / (double)my_cycle_count, my_br_count, my_br_mispred_count, (double)(my_br_count) / (double)(my_cycle_count), (double)(my_br_mispred_count) / (double)(my_cycle_count), 100.0 * ((double)(my_br_mispred_count) / (double)(my_br_count)), 1000.0 * ((double)(my_br_mispred_count) / (double)(my_instr_count)), my_wpc_count, cyc_wp_avg, cyc_wp_pki);
@@ -302,23 +305,12 @@ void bp_t::output_periodic_info(const std::vector<uint64_t> &num_insts_per_epoch
       const uint64_t target_instr_count = total_instr / 2;
       printf("\n---------------------------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (50 Perc instructions)---------------------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for (int epoch_index = num_insts_per_epoch.size() - 1; epoch_index >= 0; epoch_index--)
-      {
-         my_instr_count += num_insts_per_epoch.at(epoch_index);
-         my_cycle_count += num_cycles_per_epoch.at(epoch_index);
-         my_br_count += meas_conddir_n_per_epoch.at(epoch_index);
-         my_br_mispred_count += meas_conddir_m_per_epoch.at(epoch_index);
-         my_wpc_count += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-         if (my_instr_count > target_instr_count)
-         {
-            break;
-         }
-      }
+      const conddir_meas_t meas = measure_conddir(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = meas.instr;
+      const uint64_t my_cycle_count = meas.cycles;
+      const uint64_t my_br_count = meas.br;
+      const uint64_t my_br_mispred_count = meas.br_mispred;
+      const uint64_t my_wpc_count = meas.cycles_on_wrong_path;
       const double cyc_wp_avg = (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count / (double)my_br_mispred_count;
       const double cyc_wp_pki = (double)my_wpc_count * 1000 / (double)my_instr_count;
       printf("%12ld %12ld %8.4f %10ld %10ld %8.4lf %12.4lf %8.4lf%% %8.4lf %10ld %10.4lf %10.4lf\n", my_instr_count, my_cycle_count, (double)my_instr_count / (double)my_cycle_count, my_br_count, my_br_mispred_count, (double)(my_br_count) / (double)(my_cycle_count), (double)(my_br_mispred_count) / (double)(my_cycle_count), 100.0 * ((double)(my_br_mispred_count) / (double)(my_br_count)), 1000.0 * ((double)(my_br_mispred_count) / (double)(my_instr_count)), my_wpc_count, cyc_wp_avg, cyc_wp_pki);
@@ -330,23 +322,12 @@ void bp_t::output_periodic_info(const std::vector<uint64_t> &num_insts_per_epoch
       const uint64_t target_instr_count = total_instr;
       printf("\n-------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (Full Simulation i.e. Counts Not Reset When Warmup Ends)-------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for (int epoch_index = num_insts_per_epoch.size() - 1; epoch_index >= 0; epoch_index--)
-      {
-         my_instr_count += num_insts_per_epoch.at(epoch_index);
-         my_cycle_count += num_cycles_per_epoch.at(epoch_index);
-         my_br_count += meas_conddir_n_per_epoch.at(epoch_index);
-         my_br_mispred_count += meas_conddir_m_per_epoch.at(epoch_index);
-         my_wpc_count += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-         if (my_instr_count > target_instr_count)
-         {
-            break;
-         }
-      }
+      const conddir_meas_t meas = measure_conddir(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = meas.instr;
+      const uint64_t my_cycle_count = meas.cycles;
+      const uint64_t my_br_count = meas.br;
+      const uint64_t my_br_mispred_count = meas.br_mispred;
+      const uint64_t my_wpc_count = meas.cycles_on_wrong_path;
       const double cyc_wp_avg = (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count / (double)my_br_mispred_count;
       const double cyc_wp_pki = (double)my_wpc_count * 1000 / (double)my_instr_count;
       printf("%12ld %12ld %8.4f %10ld %10ld %8.4lf %12.4lf %8.4lf%% %8.4lf %10ld %10.4lf %10.4lf\n", my_instr_count, my_cycle_count, (double)my_instr_count / (double)my_cycle_count, my_br_count, my_br_mispred_count, (double)(my_br_count) / (double)(my_cycle_count), (double)(my_br_mispred_count) / (double)(my_cycle_count), 100.0 * ((double)(my_br_mispred_count) / (double)(my_br_count)), 1000.0 * ((double)(my_br_mispred_count) / (double)(my_instr_count)), my_wpc_count, cyc_wp_avg, cyc_wp_pki);
@@ -22,8 +22,13 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 // Modified by A. Seznec (andre.seznec@inria.fr) to include TAGE-SC-L predictor and the ITTAGE indirect branch predictor
 
+#ifndef _BP_H_
+#define _BP_H_
+
 #include "ittage.h"
 
+class CondDirPredictor;
+
 class ras_t {
 private:
     uint64_t *ras;
@@ -61,6 +66,9 @@ private:
     // Indirect target predictor based on ITTAGE
     IPREDICTOR *ITTAGE = nullptr;
 
+    // Conditional branch direction predictor (not owned).
+    CondDirPredictor *cond_pred;
+
     // Return address stack for predicting return targets.
     //ras_t ras;
     //
@@ -99,17 +107,36 @@ private:
     std::vector<uint64_t> meas_cycles_on_wrong_path_per_epoch;
 
 public:
-    bp_t();
+    bp_t(CondDirPredictor *cond_pred);
     ~bp_t();
 
     // Returns true if instruction is a mispredicted branch.
     // Also updates all branch predictor structures as applicable.
     bool predict(uint64_t seq_no, uint8_t piece, InstClass insn, uint64_t pc, uint64_t next_pc, const uint64_t pred_cycle);
 
+    // Accounts for non-control micro-ops that were not presented to predict() and were not mispredicted,
+    // e.g. the micro-ops left out of a branch-only replay.
+    void account_notctrl(uint64_t num_uops);
+
+    CondDirPredictor &get_cond_dir_predictor() {
+       return *cond_pred;
+    }
+
     // Output all branch prediction measurements.
     void output();
+    // Direct conditional branch measurements over a range of epochs.
+    struct conddir_meas_t {
+       uint64_t instr;
+       uint64_t cycles;
+       uint64_t br;
+       uint64_t br_mispred;
+       uint64_t cycles_on_wrong_path;
+    };
+    conddir_meas_t measure_conddir(const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch, const uint64_t target_instr_count) const;
+
     void output_periodic_info(const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch);
     void notify_begin_new_epoch();
     void update_cycles_on_wrong_path(const uint64_t cycles_on_wrong_path);
 };
 
+#endif
@@ -0,0 +1,262 @@
+// CBP Branch Stream (.cbpb)
+//
+// Distilled version of a trace for predictor-only replays (see tools/cbp_distill.cc and tools/cbp_replay.cc).
+// It keeps, for every micro-op that the branch predictor can get wrong (branches, and the rare non-control
+// micro-ops whose next_pc is not pc + 4), the arguments the simulator passes to bp_t::predict().
+// Every other micro-op is only accounted for by the gaps between seq_no's.
+//
+// The stream is gz-compressed, and fields are delta-encoded as LEB128 varints (signed ones zigzag-encoded).
+//
+// File Format :
+// Header                   - 8 bytes magic + 4 bytes version
+// Records :
+//   Info byte              - 1 byte: InstClass (bits 0-3), taken (bit 4), fall-through next_pc (bit 5)
+//   seq_no - previous      - varint
+//   piece                  - varint
+//   pc - previous pc       - zigzag varint
+//   If not fall-through:
+//      next_pc - pc        - zigzag varint
+// Trailer :
+//   BRANCH_STREAM_END      - 1 byte
+//   Num uops               - varint
+//   Num instructions       - varint
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <zlib.h>
+#include "sim_common_structs.h"
+
+static constexpr char BRANCH_STREAM_MAGIC[8] = {'C', 'B', 'P', 'B', 'R', '\0', '\0', '\0'};
+static constexpr uint32_t BRANCH_STREAM_VERSION = 1;
+static constexpr uint8_t BRANCH_STREAM_END = 0xff;
+
+struct branch_record_t
+{
+    uint64_t seq_no;
+    uint8_t piece;
+    uint64_t pc;
+    InstClass insn_class;
+    bool taken;
+    uint64_t next_pc;
+};
+
+// Same test as bp_t::predict(): the micro-ops that can show up in the branch prediction measurements.
+inline bool is_branch_stream_uop(InstClass insn_class, uint64_t pc, uint64_t next_pc)
+{
+    return is_br(insn_class) || (next_pc != pc + 4);
+}
+
+class branch_stream_writer
+{
+public:
+    branch_stream_writer(const char * name)
+        : prev_seq_no(0)
+        , prev_pc(0)
+    {
+        file = gzopen(name, "wb6");
+        if(file)
+        {
+            gzwrite(file, BRANCH_STREAM_MAGIC, sizeof(BRANCH_STREAM_MAGIC));
+            gzwrite(file, &BRANCH_STREAM_VERSION, sizeof(BRANCH_STREAM_VERSION));
+        }
+    }
+
+    ~branch_stream_writer()
+    {
+        if(file)
+            gzclose(file);
+    }
+
+    branch_stream_writer(const branch_stream_writer&) = delete;
+    branch_stream_writer& operator=(const branch_stream_writer&) = delete;
+
+    bool is_open() const
+    {
+        return file != nullptr;
+    }
+
+    void write(const branch_record_t& rec)
+    {
+        const bool fall_through = rec.next_pc == rec.pc + 4;
+        buffer.push_back(static_cast<uint8_t>(rec.insn_class) | (rec.taken << 4) | (fall_through << 5));
+        put_varint(rec.seq_no - prev_seq_no);
+        put_varint(rec.piece);
+        put_varint(zigzag(rec.pc - prev_pc));
+        if(!fall_through)
+            put_varint(zigzag(rec.next_pc - rec.pc));
+        prev_seq_no = rec.seq_no;
+        prev_pc = rec.pc;
+
+        if(buffer.size() >= FLUSH_SIZE)
+            flush();
+    }
+
+    // Writes the trailer and closes the stream.
+    void finish(uint64_t num_uops, uint64_t num_instr)
+    {
+        buffer.push_back(BRANCH_STREAM_END);
+        put_varint(num_uops);
+        put_varint(num_instr);
+        flush();
+        gzclose(file);
+        file = nullptr;
+    }
+
+private:
+    static constexpr size_t FLUSH_SIZE = 1 << 16;
+
+    gzFile file;
+    std::vector<uint8_t> buffer;
+    uint64_t prev_seq_no;
+    uint64_t prev_pc;
+
+    static uint64_t zigzag(uint64_t delta)
+    {
+        return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+    }
+
+    void put_varint(uint64_t val)
+    {
+        while(val >= 0x80)
+        {
+            buffer.push_back(static_cast<uint8_t>(val) | 0x80);
+            val >>= 7;
+        }
+        buffer.push_back(static_cast<uint8_t>(val));
+    }
+
+    void flush()
+    {
+        if(!buffer.empty())
+            gzwrite(file, buffer.data(), buffer.size());
+        buffer.clear();
+    }
+};
+
+class branch_stream_reader
+{
+public:
+    branch_stream_reader(const char * name)
+        : buffer(BUFFER_SIZE)
+        , cur(0)
+        , end(0)
+        , prev_seq_no(0)
+        , prev_pc(0)
+        , num_uops(0)
+        , num_instr(0)
+        , done(false)
+    {
+        file = gzopen(name, "rb");
+        if(file == nullptr)
+        {
+            fprintf(stderr, "Cannot open branch stream %s\n", name);
+            exit(1);
+        }
+        gzbuffer(file, 1 << 20);
+
+        char magic[sizeof(BRANCH_STREAM_MAGIC)];
+        uint32_t version = 0;
+        if(gzread(file, magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, BRANCH_STREAM_MAGIC, sizeof(magic)) != 0
+           || gzread(file, &version, sizeof(version)) != sizeof(version) || version != BRANCH_STREAM_VERSION)
+        {
+            fprintf(stderr, "%s is not a version %u branch stream\n", name, BRANCH_STREAM_VERSION);
+            exit(1);
+        }
+    }
+
+    ~branch_stream_reader()
+    {
+        gzclose(file);
+    }
+
+    branch_stream_reader(const branch_stream_reader&) = delete;
+    branch_stream_reader& operator=(const branch_stream_reader&) = delete;
+
+    // Returns false once the trailer has been read.
+    bool next(branch_record_t& rec)
+    {
+        if(done)
+            return false;
+
+        const uint8_t info = get_byte();
+        if(info == BRANCH_STREAM_END)
+        {
+            num_uops = get_varint();
+            num_instr = get_varint();
+            done = true;
+            return false;
+        }
+
+        rec.insn_class = static_cast<InstClass>(info & 0xf);
+        rec.taken = (info >> 4) & 1;
+        rec.seq_no = prev_seq_no + get_varint();
+        rec.piece = get_varint();
+        rec.pc = prev_pc + unzigzag(get_varint());
+        rec.next_pc = ((info >> 5) & 1) ? rec.pc + 4 : rec.pc + unzigzag(get_varint());
+        prev_seq_no = rec.seq_no;
+        prev_pc = rec.pc;
+        return true;
+    }
+
+    // Totals from the trailer, valid once next() has returned false.
+    uint64_t get_num_uops() const
+    {
+        return num_uops;
+    }
+
+    uint64_t get_num_instr() const
+    {
+        return num_instr;
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    gzFile file;
+    std::vector<uint8_t> buffer;
+    size_t cur;
+    size_t end;
+    uint64_t prev_seq_no;
+    uint64_t prev_pc;
+    uint64_t num_uops;
+    uint64_t num_instr;
+    bool done;
+
+    static uint64_t unzigzag(uint64_t val)
+    {
+        return (val >> 1) ^ (~(val & 1) + 1);
+    }
+
+    uint8_t get_byte()
+    {
+        if(cur == end)
+        {
+            const int num = gzread(file, buffer.data(), buffer.size());
+            if(num <= 0)
+            {
+                fprintf(stderr, "Truncated branch stream\n");
+                exit(1);
+            }
+            cur = 0;
+            end = num;
+        }
+        return buffer[cur++];
+    }
+
+    uint64_t get_varint()
+    {
+        uint64_t val = 0;
+        for(unsigned shift = 0; ; shift += 7)
+        {
+            const uint8_t byte = get_byte();
+            val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if(!(byte & 0x80))
+                return val;
+        }
+    }
+};
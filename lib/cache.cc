@@ -42,35 +42,75 @@ cache_t::cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t lat
    this->index_mask = (num_sets - 1);
 
    this->assoc = assoc;
+   assert(num_offset_bits > 0);   // INVALID_TAG
 
-   C = new block_t *[num_sets];
-   for (uint64_t i = 0; i < num_sets; i++) {
-      C[i] = new block_t[assoc];
-      for (uint64_t j = 0; j < assoc; j++) {
-         C[i][j].valid = false;
-     C[i][j].lru = j;
-      }
+   policy = CACHE_REPLACEMENT;
+   if ((policy == CACHE_TREE_PLRU) && (!IsPow2(assoc) || (assoc > 64))) {
+      printf("Tree pseudo-LRU needs a power-of-two associativity (at most 64): using LRU for %lu-way caches\n", assoc);
+      policy = CACHE_LRU;
+   }
+   num_plru_levels = log2(assoc);
+
+   tags.assign(num_sets * assoc, INVALID_TAG);
+   timestamps.assign(num_sets * assoc, 0);
+   if (policy == CACHE_LRU) {
+      // Way assoc - 1 is the first victim of an empty set, then assoc - 2, and so on.
+      lru_stamps.resize(num_sets * assoc);
+      for (uint64_t i = 0; i < num_sets; i++)
+         for (uint64_t j = 0; j < assoc; j++)
+            lru_stamps[i * assoc + j] = (assoc - 1 - j);
+      lru_clock = assoc;
+   }
+   else {
+      plru_bits.assign(num_sets, 0);
    }
 
+   mru_block = UINT64_MAX;
+   mru_slot = 0;
+
    this->latency = latency;
    this->next_level = next_level;
 
    accesses = 0;
    misses = 0;
+   pf_accesses = 0;
+   pf_misses = 0;
 }
 
 cache_t::~cache_t() {
 }
 
-bool cache_t::is_hit(uint64_t cycle, uint64_t addr) const {
-   uint64_t tag = TAG(addr);
-   uint64_t index = INDEX(addr);
+uint64_t cache_t::find(uint64_t index, uint64_t tag) const {
+   const uint64_t *set = &tags[index * assoc];
+   uint64_t hit_way = assoc;
+   for (uint64_t way = 0; way < assoc; way++)
+      hit_way = ((set[way] == tag) ? way : hit_way);
+   return ((hit_way < assoc) ? (index * assoc + hit_way) : UINT64_MAX);
+}
 
-   for (uint64_t way = 0; way < assoc; way++) {
-      if (C[index][way].valid && (C[index][way].tag == tag)) {
-         auto avail = ((C[index][way].timestamp > (cycle + latency)) ? C[index][way].timestamp : (cycle + latency));
-         return (cycle + latency >= avail);
-      }
+uint64_t cache_t::find_victim(uint64_t index) const {
+   if (policy == CACHE_LRU) {
+      const uint64_t *stamps = &lru_stamps[index * assoc];
+      uint64_t victim_way = 0;
+      for (uint64_t way = 1; way < assoc; way++)
+         victim_way = ((stamps[way] < stamps[victim_way]) ? way : victim_way);
+      return victim_way;
+   }
+   else {
+      // Follow the bits, which point away from the recently used half.
+      const uint64_t bits = plru_bits[index];
+      uint64_t node = 1;
+      for (uint64_t level = 0; level < num_plru_levels; level++)
+         node = (node << 1) | ((bits >> node) & 1);
+      return (node - assoc);
+   }
+}
+
+bool cache_t::is_hit(uint64_t cycle, uint64_t addr) const {
+   const uint64_t slot = (((addr >> num_offset_bits) == mru_block) ? mru_slot : find(INDEX(addr), TAG(addr)));
+   if (slot != UINT64_MAX) {
+      auto avail = ((timestamps[slot] > (cycle + latency)) ? timestamps[slot] : (cycle + latency));
+      return (cycle + latency >= avail);
    }
 
    return false;
@@ -80,39 +120,27 @@ uint64_t cache_t::access(uint64_t cycle, bool read, uint64_t addr, bool pf) {
    uint64_t avail;      // return value: cycle that requested block is available
    uint64_t tag = TAG(addr);
    uint64_t index = INDEX(addr);
-   bool hit = false;
-   uint64_t way;        // if hit, this is the corresponding way
-   uint64_t max_lru_ctr = 0;    // for finding lru block
-   uint64_t victim_way;     // if miss, this is the lru/victim way
 
    accesses+=!pf;
    pf_accesses += pf;
 
-   for (way = 0; way < assoc; way++)
-   {
-      if (C[index][way].valid && (C[index][way].tag == tag))
-      {
-         hit = true;
-         break;
-      }
-      else if (C[index][way].lru >= max_lru_ctr)
-      {
-         max_lru_ctr = C[index][way].lru;
-         victim_way = way;
-      }
+   // Same block as the last access: a hit on the MRU way of its set.
+   if ((addr >> num_offset_bits) == mru_block) {
+      return ((timestamps[mru_slot] > (cycle + latency)) ? timestamps[mru_slot] : (cycle + latency));
    }
 
-   if (hit) {   // hit
+   uint64_t slot = find(index, tag);
+   if (slot != UINT64_MAX) {   // hit
       // determine when the requested block will be available
-      avail = ((C[index][way].timestamp > (cycle + latency)) ? C[index][way].timestamp : (cycle + latency));
+      avail = ((timestamps[slot] > (cycle + latency)) ? timestamps[slot] : (cycle + latency));
 
-      update_lru(index, way);   // make "way" the MRU way
+      update_lru(index, slot - index * assoc);   // make "way" the MRU way
    }
    else {   // miss
       misses+= !pf;
       pf_misses += pf;
 
-      assert(max_lru_ctr == (assoc - 1));
+      const uint64_t victim_way = find_victim(index);
       assert(victim_way < assoc);
       
       // TO DO: model writebacks (evictions of dirty blocks)
@@ -121,23 +149,31 @@ uint64_t cache_t::access(uint64_t cycle, bool read, uint64_t addr, bool pf) {
       avail = (next_level ? next_level->access((cycle + latency), read, addr, pf) : (cycle + latency + MAIN_MEMORY_LATENCY));
 
       // replace the victim block with the requested block
-      C[index][victim_way].valid = true;
-      C[index][victim_way].tag = tag;
-      C[index][victim_way].timestamp = avail;
+      slot = index * assoc + victim_way;
+      tags[slot] = tag;
+      timestamps[slot] = avail;
       update_lru(index, victim_way);  // make "victim_way" the MRU way
    }
 
+   mru_block = (addr >> num_offset_bits);
+   mru_slot = slot;
    return(avail);
 }
 
 void cache_t::update_lru(uint64_t index, uint64_t mru_way) {
-   for (uint64_t way = 0; way < assoc; way++) {
-      if (C[index][way].lru < C[index][mru_way].lru) {
-         C[index][way].lru++;
-         assert(C[index][way].lru < assoc);
+   if (policy == CACHE_LRU) {
+      lru_stamps[index * assoc + mru_way] = lru_clock++;
+   }
+   else {
+      // Point every node on the path to mru_way away from it.
+      uint64_t &bits = plru_bits[index];
+      uint64_t node = 1;
+      for (uint64_t level = 0; level < num_plru_levels; level++) {
+         const uint64_t dir = (mru_way >> (num_plru_levels - 1 - level)) & 1;
+         bits = (bits & ~(1lu << node)) | ((dir ^ 1) << node);
+         node = (node << 1) | dir;
       }
    }
-   C[index][mru_way].lru = 0;
 }
 
 void cache_t::stats() {
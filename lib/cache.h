@@ -22,26 +22,44 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 
 
-struct block_t {
-    bool valid;
-    //bool dirty;   // TO DO
-    uint64_t tag;
-    uint64_t timestamp;
-    uint64_t lru;
-};
+#include <cstdint>
+#include <vector>
+
+// Replacement policies (CACHE_REPLACEMENT).
+#define CACHE_LRU        0   // true LRU
+#define CACHE_TREE_PLRU  1   // tree pseudo-LRU (power-of-two associativity)
 
 #define IsPow2(x)   (((x) & (x-1)) == 0)
 
 #define TAG(addr)   ((addr) >> (num_index_bits + num_offset_bits))
 #define INDEX(addr) (((addr) >> num_offset_bits) & index_mask)
 
+// Tag of the ways that do not hold a block (no address has it: tags are at least num_offset_bits shorter).
+#define INVALID_TAG (~0lu)
+
+// The ways of a set are contiguous in flat arrays: tags (searched without branches, so that the compiler can
+// vectorize the tag match), availability timestamps, and the replacement state.
+// LRU keeps a last-use stamp per way: a hit is one store, a miss picks the way with the oldest stamp.
+// Tree pseudo-LRU keeps assoc - 1 bits per set.
+// The last block accessed is remembered: it is the MRU block of its set, so accessing it again needs no search
+// and no replacement update.
 class cache_t {
 private:
-    block_t **C;
+    std::vector<uint64_t> tags;
+    std::vector<uint64_t> timestamps;
+    std::vector<uint64_t> lru_stamps;   // CACHE_LRU: last use of each way
+    std::vector<uint64_t> plru_bits;    // CACHE_TREE_PLRU: one tree per set, node n (1 to assoc - 1) is bit n
+    uint64_t lru_clock;
     uint64_t num_index_bits;
     uint64_t num_offset_bits;
     uint64_t index_mask;
     uint64_t assoc;
+    uint64_t num_plru_levels;
+    uint64_t policy;
+
+    // MRU filter: last block (addr >> num_offset_bits) accessed, and its position in the flat arrays.
+    uint64_t mru_block;
+    uint64_t mru_slot;
 
     // latency to search this cache for requested block
     uint64_t latency;
@@ -55,6 +73,9 @@ private:
     uint64_t misses;
     uint64_t pf_misses;
 
+    // Position of the block with tag in set index, or UINT64_MAX on a miss.
+    uint64_t find(uint64_t index, uint64_t tag) const;
+    uint64_t find_victim(uint64_t index) const;
     void update_lru(uint64_t index, uint64_t mru_way);
 
 public:
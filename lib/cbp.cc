@@ -35,6 +35,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "resource_schedule.h"
 #include "uarchsim.h"
 #include "parameters.h"
+#include "predictor_driver.h"
+#include "predictor_registry.h"
 
 uarchsim_t *sim;
 uint64_t sim_insts = 0;
@@ -62,6 +64,11 @@ int parseargs(int argc, char **argv)
       //    PERFECT_INDIRECT_PRED = true;
       //    i++;
       // }
+      else if (!strcmp(argv[i], "-R"))
+      {
+         TRACE_READAHEAD = true;
+         i++;
+      }
       else if (!strcmp(argv[i], "-P"))
       {
          PREFETCHER_ENABLE = true;
@@ -165,6 +172,25 @@ int parseargs(int argc, char **argv)
             exit(0);
          }
       }
+      else if (!strcmp(argv[i], "-c"))
+      {
+         i++;
+         if ((i < argc) && !strcmp(argv[i], "lru"))
+         {
+            CACHE_REPLACEMENT = CACHE_LRU;
+            i++;
+         }
+         else if ((i < argc) && !strcmp(argv[i], "plru"))
+         {
+            CACHE_REPLACEMENT = CACHE_TREE_PLRU;
+            i++;
+         }
+         else
+         {
+            printf("Usage: missing or unknown cache replacement policy: -c <lru|plru>\n");
+            exit(0);
+         }
+      }
       else if (!strcmp(argv[i], "-D"))
       {
          i++;
@@ -277,6 +303,99 @@ int parseargs(int argc, char **argv)
             exit(0);
          }
       }
+      else if (!strcmp(argv[i], "-X"))
+      {
+         i++;
+         if ((i < argc) && !strcmp(argv[i], "predictor-only"))
+         {
+            PREDICTOR_ONLY = true;
+            i++;
+         }
+         else
+         {
+            printf("Usage: missing or unknown mode: -X predictor-only\n");
+            exit(0);
+         }
+      }
+      else if (!strcmp(argv[i], "-u"))
+      {
+         i++;
+         if (i < argc)
+         {
+            uint64_t _uops;
+            if (sscanf(argv[i], "%lu", &_uops) == 1)
+            {
+               PREDICTOR_UPDATE_DELAY = _uops;
+            }
+            else
+            {
+               printf("Usage: missing update delay: -u <num_uops>\n");
+               exit(0);
+            }
+            i++;
+         }
+         else
+         {
+            printf("Usage: missing update delay: -u <num_uops>\n");
+            exit(0);
+         }
+      }
+      else if (!strcmp(argv[i], "-m"))
+      {
+         i++;
+         if (i < argc)
+         {
+            PREDICTOR_NAMES = argv[i];
+            i++;
+         }
+         else
+         {
+            printf("Usage: missing predictor name: -m <name>[,<name>...]\n");
+            exit(0);
+         }
+      }
+      else if (!strcmp(argv[i], "-J"))
+      {
+         i++;
+         if (i < argc)
+         {
+            uint64_t _insts;
+            if (sscanf(argv[i], "%lu", &_insts) == 1)
+            {
+               TRACE_START_INSTR = _insts;
+            }
+            else
+            {
+               printf("Usage: missing start instruction: -J <trace_inst>\n");
+               exit(0);
+            }
+            i++;
+         }
+         else
+         {
+            printf("Usage: missing start instruction: -J <trace_inst>\n");
+            exit(0);
+         }
+      }
+      else if (!strcmp(argv[i], "-L"))
+      {
+         i++;
+         static char trace_file[4096];
+         unsigned long temp1, temp2;
+         if ((i < argc) && (sscanf(argv[i], "%4095[^,],%lu,%lu", trace_file, &temp1, &temp2) == 3))
+         {
+            LOG_LEVEL = 1;
+            ACTIVITY_TRACE_FILE = trace_file;
+            LOG_START_CYCLE = temp1;
+            LOG_END_CYCLE = temp2;
+            i++;
+         }
+         else
+         {
+            printf("Usage: missing activity trace file or cycles: -L <trace_file>,<start_cycle>,<end_cycle>\n");
+            exit(0);
+         }
+      }
       else if (!strcmp(argv[i], "-w"))
       {
          i++;
@@ -317,24 +436,93 @@ int parseargs(int argc, char **argv)
              "\t[optional: -F <fetch_width>,<fetch_num_branch>,<fetch_stop_at_indirect>,<fetch_stop_at_taken>,<fetch_model_icache>]\n"
              "\t[optional: -I <log2_ic_size>,<ic_assoc>,<ic_blocksize>]\n"
              "\t[optional: -D <log2_L1_size>,<L1_assoc>,<L1_blocksize>,<L1_latency>,<log2_L2_size>,<L2_assoc>,<L2_blocksize>,<L2_latency>,<log2_L3_size>,<L3_assoc>,<L3_blocksize>,<L3_latency>,<main_memory_latency>]\n"
+             "\t[optional: -c <lru|plru> cache replacement policy: LRU (default) or tree pseudo-LRU]\n"
              "\t[optional: -w <window_size>]\n"
              "\t[optional: -E <epoch_size_insts> to enable dumping per-epoch conditional branch info\n"
              "\t[optional: -S <simulation_insts> number of insts to simulate\n"
              "\t[optional: -H <num_insts> print heartbeat after N instructions\n"
-             "\t[REQUIRED: .gz trace file]\n",
+             "\t[optional: -R to decompress the trace in a background thread (read-ahead)]\n"
+             "\t[optional: -X predictor-only to only drive the branch predictor, without the timing model]\n"
+             "\t[optional: -u <num_uops> predictor-only mode: resolve/commit branches N micro-ops after their prediction]\n"
+             "\t[optional: -m <name> registered predictor to simulate (default: my_pred); predictor-only mode: -m <name>,<name>... evaluates several in one pass]\n"
+             "\t[optional: -J <trace_inst> start at trace instruction N, using the trace's .tidx index if present]\n"
+             "\t[optional: -L <trace_file>,<start_cycle>,<end_cycle> record the pipeline activity of these cycles (render it with cbp_activity)]\n"
+             "\t[REQUIRED: .gz or .cbpt trace file]\n",
              argv[0]);
       exit(0);
    }
 }
 
+// Predictor-only mode: the trace is presented to the branch predictor in program order (see predictor_driver.h),
+// without stepping the timing model.
+// Each of the predictors named by -m is presented the same micro-ops and has its own measurements.
+static void run_predictor_only(TraceReader &reader, const std::vector<std::string> &pred_names)
+{
+   predictor_driver_t driver(PREDICTOR_UPDATE_DELAY, pred_names);
+   clock_t sim_start_time = clock();
+   clock_t last_heartbeat_time = sim_start_time;
+
+   driver.begin();
+
+   db_t inst;
+   uint64_t inst_count = 0;
+   uint64_t seq_no = 0;
+   uint64_t num_inst = 0;
+   uint8_t piece = 0;
+   while (reader.get_inst(inst))
+   {
+      driver.step(seq_no, piece, inst.insn_class, inst.is_taken, inst.pc, inst.next_pc);
+      seq_no++;
+      if (inst.is_last_piece)
+      {
+         num_inst++;
+         piece = 0;
+      }
+      else
+      {
+         piece++;
+      }
+
+      inst_count++;
+      if (!(inst_count % heartbeat_insts))
+      {
+         printf("[HEARTBEAT] Simulated %lu insts (epoch: %.1fs, total: %.1fs)\n", inst_count, (double)(clock() - last_heartbeat_time) / CLOCKS_PER_SEC, (double)(clock() - sim_start_time) / CLOCKS_PER_SEC);
+         last_heartbeat_time = clock();
+      }
+      if (sim_insts && inst_count >= sim_insts)
+      {
+         printf("Simulated %lu instructions, stoping simulation...\n", sim_insts);
+         break;
+      }
+   }
+   driver.finish(seq_no, num_inst);
+
+   endPredictor();
+   driver.end();
+   driver.output();
+}
+
 int main(int argc, char **argv)
 {
    int i = parseargs(argc, argv);
-   TraceReader reader(argv[i]);
+   TraceReader reader(argv[i], TRACE_READAHEAD, TRACE_START_INSTR);
    uint64_t inst_count = 0;
 
+   const std::vector<std::string> pred_names = split_predictor_names(PREDICTOR_NAMES);
+   if (pred_names.empty() || (!PREDICTOR_ONLY && pred_names.size() != 1))
+   {
+      printf("Usage: -m <name> (several predictors -m <name>,<name>... require -X predictor-only)\n");
+      exit(0);
+   }
+   if (PREDICTOR_ONLY)
+   {
+      run_predictor_only(reader, pred_names);
+      return 0;
+   }
+
    // Need to create simulator after parsing arguments (for global parameters).
-   sim = new uarchsim_t;
+   CondDirPredictor *cond_pred = create_registered_predictor(pred_names[0]);
+   sim = new uarchsim_t(cond_pred);
 
    clock_t sim_start_time = clock();
    clock_t last_heartbeat_time = sim_start_time;
@@ -350,9 +538,11 @@ int main(int argc, char **argv)
    //    beginCondDirPredictor((argc - i), &(argv[i]));
    // else
    //    beginCondDirPredictor(0, (char **)NULL);
-   beginCondDirPredictor();
+   sim->begin();
 
-   db_t *inst = reader.get_inst();
+   // Pieces are delivered into a single caller-owned db_t, overwritten by every get_inst().
+   db_t inst_piece;
+   db_t *inst = reader.get_inst(inst_piece) ? &inst_piece : nullptr;
    inst_count++;
 
    // bool dump_activity = true;
@@ -381,9 +571,7 @@ int main(int argc, char **argv)
       //     std::cout<<"======================================================= End "<<current_fetch_cycle<<"->"<<next_fetch_cycle<<"=======================================================\n";
       // }
       // current_fetch_cycle = next_fetch_cycle;
-      delete inst;
-
-      inst = reader.get_inst();
+      inst = reader.get_inst(inst_piece) ? &inst_piece : nullptr;
       inst_count++;
       if (sim_insts && inst_count >= sim_insts)
       {
@@ -393,6 +581,6 @@ int main(int argc, char **argv)
    }
 
    endPredictor();
-   endCondDirPredictor();
+   cond_pred->endCondDirPredictor();
    sim->output();
 }
@@ -0,0 +1,241 @@
+// CBP Native Trace (.cbpt)
+//
+// Uncompressed, memory-mappable version of the gz trace format parsed by TraceReader::readInstr().
+// Converting a trace once (see tools/cbpt_convert.cc) lets every later run stream it at memory bandwidth:
+// the file is mmap'ed with MADV_SEQUENTIAL and each record is decoded with pointer arithmetic.
+//
+// File Format :
+// File header              - 64 bytes (cbpt_file_header_t)
+// Records                  - one per trace instruction, length-prefixed, 8-byte aligned
+//
+// Record Format :
+// Fixed part               - 24 bytes (cbpt_record_t)
+// Input Reg Names          - 1 byte each
+// Output Reg Names         - 1 byte each
+// Padding                  - up to the next 8-byte boundary
+// Output Reg Values        - 8 bytes each, in trace order (SIMD registers have two: low then high)
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr char CBPT_MAGIC[8] = {'C', 'B', 'P', 'T', '\0', '\0', '\0', '\0'};
+static constexpr uint32_t CBPT_VERSION = 1;
+
+struct cbpt_file_header_t
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;   // offset of the first record
+    uint64_t num_instr;     // number of records in the file
+    uint64_t reserved[5];
+};
+static_assert(sizeof(cbpt_file_header_t) == 64, "cbpt file header must be 64 bytes");
+
+enum cbpt_flags : uint8_t
+{
+    CBPT_TAKEN      = 1 << 0,
+    CBPT_BASE_UPD   = 1 << 1,
+    CBPT_REG_OFFSET = 1 << 2,
+};
+
+struct cbpt_record_t
+{
+    uint64_t pc;
+    uint64_t addr;          // effective address for loads/stores, target for taken branches
+    uint16_t size;          // record size in bytes, including this fixed part
+    uint8_t type;           // InstClass
+    uint8_t flags;          // cbpt_flags
+    uint8_t mem_size;
+    uint8_t num_in_regs;
+    uint8_t num_out_regs;
+    uint8_t num_values;
+
+    const uint8_t * in_regs() const
+    {
+        return reinterpret_cast<const uint8_t*>(this + 1);
+    }
+
+    const uint8_t * out_regs() const
+    {
+        return in_regs() + num_in_regs;
+    }
+
+    const uint64_t * values() const
+    {
+        return reinterpret_cast<const uint64_t*>(reinterpret_cast<const uint8_t*>(this) + values_offset(num_in_regs, num_out_regs));
+    }
+
+    static size_t values_offset(uint8_t num_in_regs, uint8_t num_out_regs)
+    {
+        return (sizeof(cbpt_record_t) + num_in_regs + num_out_regs + 7) & ~(size_t)7;
+    }
+};
+static_assert(sizeof(cbpt_record_t) == 24, "cbpt record fixed part must be 24 bytes");
+
+inline bool is_cbpt_trace(const char * trace_name)
+{
+    const size_t len = strlen(trace_name);
+    return (len >= 5) && (strcmp(trace_name + len - 5, ".cbpt") == 0);
+}
+
+// Read side: maps the whole file and hands out records in order.
+class cbpt_reader
+{
+public:
+    cbpt_reader(const char * trace_name)
+    {
+        const int fd = open(trace_name, O_RDONLY);
+        if(fd < 0)
+        {
+            fprintf(stderr, "Cannot open cbpt trace %s\n", trace_name);
+            exit(1);
+        }
+        struct stat st;
+        fstat(fd, &st);
+        map_len = st.st_size;
+        if(map_len < sizeof(cbpt_file_header_t))
+        {
+            fprintf(stderr, "Truncated cbpt trace %s\n", trace_name);
+            exit(1);
+        }
+
+        map_base = mmap(nullptr, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if(map_base == MAP_FAILED)
+        {
+            fprintf(stderr, "Cannot mmap cbpt trace %s\n", trace_name);
+            exit(1);
+        }
+        madvise(map_base, map_len, MADV_SEQUENTIAL);
+
+        const auto * header = static_cast<const cbpt_file_header_t*>(map_base);
+        if(memcmp(header->magic, CBPT_MAGIC, sizeof(CBPT_MAGIC)) != 0 || header->version != CBPT_VERSION)
+        {
+            fprintf(stderr, "%s is not a version %u cbpt trace\n", trace_name, CBPT_VERSION);
+            exit(1);
+        }
+
+        num_instr = header->num_instr;
+        num_read = 0;
+        cur = static_cast<const uint8_t*>(map_base) + header->header_size;
+        end = static_cast<const uint8_t*>(map_base) + map_len;
+    }
+
+    ~cbpt_reader()
+    {
+        munmap(map_base, map_len);
+    }
+
+    cbpt_reader(const cbpt_reader&) = delete;
+    cbpt_reader& operator=(const cbpt_reader&) = delete;
+
+    // Returns the next record, or nullptr once all the instructions have been read.
+    const cbpt_record_t * next()
+    {
+        if(num_read == num_instr || cur >= end)
+            return nullptr;
+
+        const auto * rec = reinterpret_cast<const cbpt_record_t*>(cur);
+        assert(rec->size >= sizeof(cbpt_record_t) && (rec->size % 8) == 0);
+        assert(cur + rec->size <= end);
+        cur += rec->size;
+        num_read++;
+        return rec;
+    }
+
+    uint64_t get_num_instr() const
+    {
+        return num_instr;
+    }
+
+private:
+    void * map_base;
+    size_t map_len;
+    const uint8_t * cur;
+    const uint8_t * end;
+    uint64_t num_instr;
+    uint64_t num_read;
+};
+
+// Write side: used by the converter to append records and patch the instruction count at the end.
+class cbpt_writer
+{
+public:
+    cbpt_writer(const char * trace_name)
+        : out(trace_name, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc)
+        , num_instr(0)
+    {
+        write_header();
+    }
+
+    bool is_open() const
+    {
+        return out.is_open();
+    }
+
+    void write(uint8_t type, uint64_t pc, uint64_t addr, uint8_t flags, uint8_t mem_size,
+               const uint8_t * in_regs, uint8_t num_in_regs, const uint8_t * out_regs, uint8_t num_out_regs,
+               const uint64_t * values, uint8_t num_values)
+    {
+        const size_t values_offset = cbpt_record_t::values_offset(num_in_regs, num_out_regs);
+        const size_t rec_size = values_offset + num_values * sizeof(uint64_t);
+        assert(rec_size <= UINT16_MAX);
+
+        buffer.assign(rec_size, 0);
+        auto * rec = reinterpret_cast<cbpt_record_t*>(buffer.data());
+        rec->pc = pc;
+        rec->addr = addr;
+        rec->size = rec_size;
+        rec->type = type;
+        rec->flags = flags;
+        rec->mem_size = mem_size;
+        rec->num_in_regs = num_in_regs;
+        rec->num_out_regs = num_out_regs;
+        rec->num_values = num_values;
+        memcpy(buffer.data() + sizeof(cbpt_record_t), in_regs, num_in_regs);
+        memcpy(buffer.data() + sizeof(cbpt_record_t) + num_in_regs, out_regs, num_out_regs);
+        memcpy(buffer.data() + values_offset, values, num_values * sizeof(uint64_t));
+
+        out.write(reinterpret_cast<const char*>(buffer.data()), rec_size);
+        num_instr++;
+    }
+
+    // Rewrites the header with the final instruction count.
+    void finish()
+    {
+        out.seekp(0);
+        write_header();
+        out.close();
+    }
+
+    uint64_t get_num_instr() const
+    {
+        return num_instr;
+    }
+
+private:
+    std::ofstream out;
+    uint64_t num_instr;
+    std::vector<uint8_t> buffer;
+
+    void write_header()
+    {
+        cbpt_file_header_t header = {};
+        memcpy(header.magic, CBPT_MAGIC, sizeof(CBPT_MAGIC));
+        header.version = CBPT_VERSION;
+        header.header_size = sizeof(cbpt_file_header_t);
+        header.num_instr = num_instr;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+};
@@ -0,0 +1,97 @@
+// Timing wheel (calendar queue) of events keyed by cycle.
+//
+// One bucket per cycle, in a circular array indexed by cycle modulo depth, like resource_schedule.
+// Every pending event is in [base_cycle, base_cycle + depth); the wheel doubles its depth when an event
+// is scheduled past that. Draining a cycle visits its events in scheduling order, in O(1) per event,
+// and advances base_cycle to it: cycles must be drained in non-decreasing order, and cycles with events
+// may not be skipped (next_cycle() finds them). The same cycle can be drained again, for events scheduled
+// for it after it was first drained.
+
+#ifndef _EVENT_WHEEL_H
+#define _EVENT_WHEEL_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#define EVENT_WHEEL_DEPTH 1024
+
+template <class T>
+class event_wheel_t {
+private:
+   std::vector<std::vector<T>> buckets;
+   std::vector<uint64_t> occupied;    // one bit per bucket: bucket not empty
+   uint64_t mask;
+   uint64_t base_cycle;
+
+   void resize(uint64_t min_depth)
+   {
+      uint64_t depth = buckets.size();
+      while (depth < min_depth)
+         depth <<= 1;
+
+      std::vector<std::vector<T>> old(depth);
+      old.swap(buckets);
+      occupied.assign(depth / 64, 0);
+      for (uint64_t cycle = base_cycle; cycle < base_cycle + old.size(); cycle++)
+      {
+         const uint64_t pos = cycle & (depth - 1);
+         buckets[pos].swap(old[cycle & mask]);
+         if (!buckets[pos].empty())
+            occupied[pos / 64] |= (1lu << (pos % 64));
+      }
+      mask = depth - 1;
+   }
+
+public:
+   event_wheel_t(uint64_t depth = EVENT_WHEEL_DEPTH)
+      : buckets(depth), occupied(depth / 64, 0), mask(depth - 1), base_cycle(0)
+   {
+      assert((depth >= 64) && !(depth & (depth - 1)));
+   }
+
+   void schedule(uint64_t cycle, const T &event)
+   {
+      assert(cycle >= base_cycle);
+      if (cycle - base_cycle > mask)
+         resize(cycle - base_cycle + 1);
+      buckets[cycle & mask].push_back(event);
+      occupied[(cycle & mask) / 64] |= (1lu << ((cycle & mask) % 64));
+   }
+
+   // First cycle in [from, to] that has events, or UINT64_MAX if none.
+   uint64_t next_cycle(uint64_t from, uint64_t to) const
+   {
+      assert(from >= base_cycle);
+      to = std::min(to, base_cycle + mask);   // No event past that.
+      uint64_t cycle = from;
+      while (cycle <= to)
+      {
+         const uint64_t pos = cycle & mask;
+         const uint64_t bits = occupied[pos / 64] >> (pos % 64);
+         if (bits)
+         {
+            cycle += __builtin_ctzl(bits);
+            return ((cycle <= to) ? cycle : UINT64_MAX);
+         }
+         cycle += 64 - (pos % 64);
+      }
+      return UINT64_MAX;
+   }
+
+   // Calls f(event) for every event of cycle, in scheduling order, and removes them.
+   template <class F>
+   void drain(uint64_t cycle, F &&f)
+   {
+      assert(cycle >= base_cycle);
+      base_cycle = cycle;
+      std::vector<T> &bucket = buckets[cycle & mask];
+      for (size_t i = 0; i < bucket.size(); i++)
+         f(bucket[i]);
+      bucket.clear();
+      occupied[(cycle & mask) / 64] &= ~(1lu << ((cycle & mask) % 64));
+   }
+};
+
+#endif
@@ -0,0 +1,106 @@
+// Folded global histories of TAGE-like predictors, updated all at once.
+//
+// A TAGE table with a history length of OLENGTH bits is indexed and tagged with that history folded (XOR-compressed)
+// into three cyclic shift registers: one as wide as the table index, two as wide as the tag and the tag minus one bit
+// (see P. Michaud's PPM-like predictor at CBP-1). Every new global history bit is shifted into all of them, and the bit
+// that leaves each table's history length is XORed out.
+//
+// The registers of all the tables are kept as a struct of arrays, and update() updates them together: with AVX2 when
+// the build targets it (e.g. make OPT="-O3 -mavx2"), with a scalar loop otherwise, to the same bits. The three registers
+// of a table fold the same history length, so the bit leaving it is read once per table. The registers of the tables
+// that are not initialized stay 0.
+
+#ifndef _FOLDED_HISTORY_H
+#define _FOLDED_HISTORY_H
+
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+template <int NUM_TABLES>
+class folded_history_bank_t {
+private:
+   static constexpr int LANES = 8;     // 32-bit registers per AVX2 vector
+   static constexpr int SLOTS = ((NUM_TABLES + LANES - 1) / LANES) * LANES;
+   enum { INDEX = 0, TAG0 = 1, TAG1 = 2, NUM_KINDS = 3 };
+
+   alignas(32) uint32_t comp[NUM_KINDS][SLOTS];
+   alignas(32) uint32_t clength[NUM_KINDS][SLOTS];
+   alignas(32) uint32_t outpoint[NUM_KINDS][SLOTS];
+   alignas(32) uint32_t mask[NUM_KINDS][SLOTS];
+   int olength[SLOTS];
+
+   void init_register(int kind, int table, int original_length, int compressed_length)
+   {
+      comp[kind][table] = 0;
+      clength[kind][table] = compressed_length;
+      outpoint[kind][table] = original_length % compressed_length;
+      mask[kind][table] = (1u << compressed_length) - 1;
+   }
+
+public:
+   folded_history_bank_t()
+   {
+      memset(comp, 0, sizeof(comp));
+      memset(clength, 0, sizeof(clength));
+      memset(outpoint, 0, sizeof(outpoint));
+      memset(mask, 0, sizeof(mask));
+      memset(olength, 0, sizeof(olength));
+   }
+
+   // Table folds the last original_length history bits into index_length bits for its index, and into tag_length and
+   // tag_length - 1 bits for its tag. Clears its registers.
+   void init(int table, int original_length, int index_length, int tag_length)
+   {
+      olength[table] = original_length;
+      init_register(INDEX, table, original_length, index_length);
+      init_register(TAG0, table, original_length, tag_length);
+      init_register(TAG1, table, original_length, tag_length - 1);
+   }
+
+   uint32_t index(int table) const { return comp[INDEX][table]; }
+   uint32_t tag0(int table) const { return comp[TAG0][table]; }
+   uint32_t tag1(int table) const { return comp[TAG1][table]; }
+
+   // Shifts h[PT] into all the registers: h is a circular buffer of buffer_length (a power of two) history bits,
+   // one per byte, whose newest bit is at PT and older bits at increasing positions.
+   void update(const uint8_t *h, int PT, int buffer_length)
+   {
+      const uint32_t in = h[PT & (buffer_length - 1)];
+      alignas(32) uint32_t out[SLOTS];
+      for (int t = 0; t < SLOTS; t++)
+         out[t] = h[(PT + olength[t]) & (buffer_length - 1)];
+
+#if defined(__AVX2__)
+      const __m256i vin = _mm256_set1_epi32(in);
+      for (int kind = 0; kind < NUM_KINDS; kind++)
+      {
+         for (int t = 0; t < SLOTS; t += LANES)
+         {
+            __m256i c = _mm256_load_si256((const __m256i *)&comp[kind][t]);
+            const __m256i o = _mm256_load_si256((const __m256i *)&out[t]);
+            c = _mm256_xor_si256(_mm256_slli_epi32(c, 1), vin);
+            c = _mm256_xor_si256(c, _mm256_sllv_epi32(o, _mm256_load_si256((const __m256i *)&outpoint[kind][t])));
+            c = _mm256_xor_si256(c, _mm256_srlv_epi32(c, _mm256_load_si256((const __m256i *)&clength[kind][t])));
+            c = _mm256_and_si256(c, _mm256_load_si256((const __m256i *)&mask[kind][t]));
+            _mm256_store_si256((__m256i *)&comp[kind][t], c);
+         }
+      }
+#else
+      for (int kind = 0; kind < NUM_KINDS; kind++)
+      {
+         for (int t = 0; t < SLOTS; t++)
+         {
+            uint32_t c = (comp[kind][t] << 1) ^ in;
+            c ^= out[t] << outpoint[kind][t];
+            c ^= c >> clength[kind][t];
+            comp[kind][t] = c & mask[kind][t];
+         }
+      }
+#endif
+   }
+};
+
+#endif
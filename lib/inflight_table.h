@@ -0,0 +1,101 @@
+// Per-branch state of the in-flight branches of a predictor, from predict to commit.
+//
+// Entries live in a power-of-two ring indexed by seq_no, so insert/find/erase are one masked access, with no hashing
+// and no allocation. Every slot keeps the seq_no it holds: a lookup of a seq_no that is not in flight (e.g. update()
+// of a branch that was not predicted) finds nothing. The in-flight seq_nos span a bounded window (WINDOW_SIZE in
+// timing mode, the update delay in predictor-only mode); when a branch maps to a slot still held by another one, the
+// ring doubles until all of them map to distinct slots.
+
+#ifndef _INFLIGHT_TABLE_H
+#define _INFLIGHT_TABLE_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+template <class T>
+class inflight_table_t {
+private:
+   static constexpr uint64_t FREE = ~0ULL;     // seq_no of a free slot
+
+   struct slot_t {
+      uint64_t seq_no = FREE;
+      T entry;
+   };
+
+   std::vector<slot_t> slots;
+   uint64_t mask;
+
+   void grow()
+   {
+      uint64_t size = slots.size();
+      bool collision = true;
+      std::vector<slot_t> grown;
+      while (collision)
+      {
+         size *= 2;
+         collision = false;
+         grown.assign(size, slot_t());
+         for (const slot_t &s : slots)
+         {
+            if (s.seq_no == FREE)
+               continue;
+            slot_t &g = grown[s.seq_no & (size - 1)];
+            if (g.seq_no != FREE)
+            {
+               collision = true;
+               break;
+            }
+            g = s;
+         }
+      }
+      slots.swap(grown);
+      mask = size - 1;
+   }
+
+public:
+   // size: initial number of slots, a power of two
+   inflight_table_t(uint64_t size = 1024) : slots(size), mask(size - 1)
+   {
+      assert((size != 0) && ((size & (size - 1)) == 0));
+   }
+
+   // Entry of seq_no, reset to T() unless seq_no is already in flight (a branch predicted again keeps its entry).
+   T &insert(uint64_t seq_no)
+   {
+      while ((slots[seq_no & mask].seq_no != FREE) && (slots[seq_no & mask].seq_no != seq_no))
+         grow();
+      slot_t &s = slots[seq_no & mask];
+      if (s.seq_no != seq_no)
+      {
+         s.seq_no = seq_no;
+         s.entry = T();
+      }
+      return s.entry;
+   }
+
+   // Entry of seq_no, NULL if it is not in flight.
+   T *find(uint64_t seq_no)
+   {
+      slot_t &s = slots[seq_no & mask];
+      return ((s.seq_no == seq_no) ? &s.entry : NULL);
+   }
+
+   // Entry of seq_no, which must be in flight: the tag is only checked by the assert.
+   T &at(uint64_t seq_no)
+   {
+      slot_t &s = slots[seq_no & mask];
+      assert(s.seq_no == seq_no);
+      return s.entry;
+   }
+
+   // Frees the entry of seq_no, if it is in flight.
+   void erase(uint64_t seq_no)
+   {
+      slot_t &s = slots[seq_no & mask];
+      if (s.seq_no == seq_no)
+         s.seq_no = FREE;
+   }
+};
+
+#endif
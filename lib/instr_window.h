@@ -0,0 +1,113 @@
+// Instruction window: the in-flight micro-ops, oldest to youngest, in a ring indexed by seq_no.
+//
+// Micro-ops enter the window in seq_no order (seq_no is the micro-op count) and leave it in the same order,
+// so the window always holds a contiguous range of seq_nos and an entry is found with seq_no & mask.
+// The ring has a power-of-two number of slots, at least the window size, allocated once.
+//
+// The timing fields read on every event (window_t) are kept apart from the ExecuteInfo passed to the
+// predictor, which is only read by the decode/execute/commit notifications. The ExecuteInfo of a slot is
+// filled in place.
+
+#ifndef _INSTR_WINDOW_H
+#define _INSTR_WINDOW_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "sim_common_structs.h"
+
+struct window_t {
+   uint64_t seq_no;
+   uint8_t piece;
+   uint64_t PC;
+   uint64_t fetch_cycle;
+   uint64_t decode_cycle;
+   uint64_t exec_cycle;
+   uint64_t retire_cycle;
+   bool pred_taken;
+   uint64_t addr;
+   uint64_t value;
+   uint64_t latency;
+
+   window_t()
+     : seq_no(UINT64_MAX)
+     , piece(UINT8_MAX)
+     , PC(UINT64_MAX)
+     , fetch_cycle(UINT64_MAX)
+     , decode_cycle(UINT64_MAX)
+     , exec_cycle(UINT64_MAX)
+     , retire_cycle(UINT64_MAX)
+     , pred_taken(false)
+     , addr(UINT64_MAX)
+     , value(UINT64_MAX)
+     , latency(UINT64_MAX)
+   {
+   }
+
+   void update_pred_taken(bool _pred_taken)
+   {
+      pred_taken = _pred_taken;
+   }
+};
+
+class instr_window_t {
+private:
+   std::vector<window_t> entries;
+   std::vector<ExecuteInfo> exec_infos;
+   uint64_t mask;
+   uint64_t head;   // seq_no of the oldest entry
+   uint64_t tail;   // seq_no of the next entry to be pushed
+
+public:
+   instr_window_t(uint64_t capacity)
+      : head(0), tail(0)
+   {
+      uint64_t slots = 1;
+      while (slots < capacity)
+         slots <<= 1;
+      entries.resize(slots);
+      exec_infos.resize(slots);
+      mask = slots - 1;
+   }
+
+   bool empty() const { return (head == tail); }
+   uint64_t size() const { return (tail - head); }
+
+   window_t &front() { assert(!empty()); return entries[head & mask]; }
+   window_t &back() { assert(!empty()); return entries[(tail - 1) & mask]; }
+
+   // Entry of an in-flight micro-op.
+   window_t &operator[](uint64_t seq_no)
+   {
+      assert((seq_no >= head) && (seq_no < tail));
+      return entries[seq_no & mask];
+   }
+   ExecuteInfo &exec_info(uint64_t seq_no)
+   {
+      assert((seq_no >= head) && (seq_no < tail));
+      return exec_infos[seq_no & mask];
+   }
+
+   // Appends the entry of micro-op seq_no (the next seq_no), and returns it for the caller to fill, along with
+   // exec_info(seq_no). The window must not be full.
+   window_t &push_back(uint64_t seq_no)
+   {
+      assert((tail - head) <= mask);
+      if (empty())
+         head = seq_no;
+      else
+         assert(seq_no == tail);
+      tail = seq_no + 1;
+      window_t &entry = entries[seq_no & mask];
+      entry.seq_no = seq_no;
+      return entry;
+   }
+
+   void pop_front()
+   {
+      assert(!empty());
+      head++;
+   }
+};
+
+#endif
@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <stdlib.h>
 #include <string.h>
 #include <vector>
+#include "folded_history.h"
 
 #ifndef _ITTAGE_H
 #define _ITTAGE_H
@@ -47,33 +48,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 // Fast  implementation of the ITTAGE predictor: probably not optimal, but not
 // that far
 //
-// utility class for index computation
-// this is the cyclic shift register for folding
-// a long global history into a smaller number of bits; see P. Michaud's
-// PPM-like predictor at CBP-1
-class folded_history {
-public:
-  unsigned comp;
-  int CLENGTH;
-  int OLENGTH;
-  int OUTPOINT;
-
-  folded_history() {}
-
-  void init(int original_length, int compressed_length) {
-    comp = 0;
-    OLENGTH = original_length;
-    CLENGTH = compressed_length;
-    OUTPOINT = OLENGTH % CLENGTH;
-  }
-
-  void update(uint8_t *h, int PT) {
-    comp = (comp << 1) ^ h[PT & (HISTBUFFERLENGTH - 1)];
-    comp ^= h[(PT + OLENGTH) & (HISTBUFFERLENGTH - 1)] << OUTPOINT;
-    comp ^= (comp >> CLENGTH);
-    comp = (comp) & ((1 << CLENGTH) - 1);
-  }
-};
+// the folded histories for index and tag computation are in folded_history.h
 
 class ientry // ITTAGE global table entry
 {
@@ -116,8 +91,7 @@ public:
   uint8_t ghist[HISTBUFFERLENGTH];
   int ptghist;
   long long phist;                   // path history
-  folded_history ch_i[NHIST + 1];    // utility for computing ITTAGE indices
-  folded_history ch_t[2][NHIST + 1]; // utility for computing ITTAGE tags
+  folded_history_bank_t<NHIST + 1> ch; // utility for computing ITTAGE indices and tags
 
   ientry *itable[NHIST + 1];
   int m[NHIST + 1];
@@ -156,11 +130,8 @@ public:
     for (int i = 0; i <= NHIST; i++)
       itable[i] = new ientry[(1 << LOGG)];
 
-    for (int i = 0; i <= NHIST; i++) {
-      ch_i[i].init(m[i], (logg[i]));
-      ch_t[0][i].init(ch_i[i].OLENGTH, TB[i]);
-      ch_t[1][i].init(ch_i[i].OLENGTH, TB[i] - 1);
-    }
+    for (int i = 0; i <= NHIST; i++)
+      ch.init(i, m[i], logg[i], TB[i]);
 
     Seed = 0;
 
@@ -195,19 +166,20 @@ public:
   }
 
   // gindex computes a full hash of PC, ghist and phist
-  int gindex(unsigned int PC, int bank, long long hist, folded_history *ch_i) {
+  int gindex(unsigned int PC, int bank, long long hist,
+             const folded_history_bank_t<NHIST + 1> &ch) {
     int index;
     int M = (m[bank] > PHISTWIDTH) ? PHISTWIDTH : m[bank];
-    index = PC ^ (PC >> (abs(logg[bank] - bank) + 1)) ^ ch_i[bank].comp ^
+    index = PC ^ (PC >> (abs(logg[bank] - bank) + 1)) ^ ch.index(bank) ^
             F(hist, M, bank);
 
     return (index & ((1 << (logg[bank])) - 1));
   }
 
   //  tag computation
-  uint16_t gtag(unsigned int PC, int bank, folded_history *ch0,
-                folded_history *ch1) {
-    int tag = (PC) ^ ch0[bank].comp ^ (ch1[bank].comp << 1);
+  uint16_t gtag(unsigned int PC, int bank,
+                const folded_history_bank_t<NHIST + 1> &ch) {
+    int tag = (PC) ^ ch.tag0(bank) ^ (ch.tag1(bank) << 1);
     return (tag & ((1 << (TB[bank])) - 1));
   }
 
@@ -239,8 +211,8 @@ public:
     HitBank = -1;
     AltBank = -1;
     for (int i = 0; i <= NHIST; i++) {
-      GI[i] = gindex(PC, i, phist, ch_i);
-      GTAG[i] = gtag(PC, i, ch_t[0], ch_t[1]);
+      GI[i] = gindex(PC, i, phist, ch);
+      GTAG[i] = gtag(PC, i, ch);
     }
 
     alt_target = 0;
@@ -286,7 +258,7 @@ public:
   }
 
   void HistoryUpdate(uint64_t PC, uint64_t target, long long &X, int &Y,
-                     folded_history *H, folded_history *G, folded_history *J) {
+                     folded_history_bank_t<NHIST + 1> &ch) {
 
     int maxt = 3;
     int T = (PC >> 2) ^ (PC >> 6);
@@ -302,12 +274,7 @@ public:
       ghist[Y & (HISTBUFFERLENGTH - 1)] = DIR;
       X = (X << 1) ^ PATHBIT;
 
-      for (int i = 1; i <= NHIST; i++) {
-
-        H[i].update(ghist, Y);
-        G[i].update(ghist, Y);
-        J[i].update(ghist, Y);
-      }
+      ch.update(ghist, Y, HISTBUFFERLENGTH);
     }
 
     X = (X & ((1 << PHISTWIDTH) - 1));
@@ -317,7 +284,7 @@ public:
 
   void TrackOtherInst(uint64_t PC, uint64_t branchTarget) {
 
-    HistoryUpdate(PC, branchTarget, phist, ptghist, ch_i, ch_t[0], ch_t[1]);
+    HistoryUpdate(PC, branchTarget, phist, ptghist, ch);
   }
   // PREDICTOR UPDATE
 
@@ -419,7 +386,7 @@ public:
       }
     // END TAGE UPDATE
 
-    HistoryUpdate(PC, branchTarget, phist, ptghist, ch_i, ch_t[0], ch_t[1]);
+    HistoryUpdate(PC, branchTarget, phist, ptghist, ch);
 
     // END PREDICTOR UPDATE
   }
@@ -43,6 +43,7 @@ uint64_t NUM_ALU_LANES = 16;
 bool PREFETCHER_ENABLE = true;
 bool PERFECT_CACHE = false;
 bool WRITE_ALLOCATE = true;
+uint64_t CACHE_REPLACEMENT = 0;       // CACHE_LRU (0) or CACHE_TREE_PLRU (1), see cache.h
 
 uint64_t IC_SIZE = (1 << 17);
 uint64_t IC_ASSOC = 8;
@@ -72,6 +73,7 @@ uint64_t SLOW_ALU_EXEC_LATENCY = 4;
 uint64_t LOG_LEVEL = 0;
 uint64_t LOG_START_CYCLE = 0;
 uint64_t LOG_END_CYCLE = 0;
+const char *ACTIVITY_TRACE_FILE = "activity.cbpa"; // activity trace of cycles LOG_START_CYCLE to LOG_END_CYCLE, if LOG_LEVEL != 0
 
 uint64_t DQ_LATENCY = 2;
 
@@ -79,3 +81,10 @@ uint64_t MISP_REDUCTION_PERC = 0;
 
 uint64_t EPOCH_SIZE_INSTS = 1000000;
 bool PRINT_PER_EPOCH_STATS = false;
+
+bool TRACE_READAHEAD = false;         // inflate the trace in a background thread
+uint64_t TRACE_START_INSTR = 0;      // first trace instruction to simulate (uses the trace's .tidx index if present)
+
+bool PREDICTOR_ONLY = false;          // drive the branch predictor only, without the timing model
+uint64_t PREDICTOR_UPDATE_DELAY = 0;  // predictor-only mode: micro-ops between a branch's prediction and its resolve/commit
+const char *PREDICTOR_NAMES = "my_pred"; // registered predictor to simulate (predictor-only mode: comma-separated list, evaluated in one pass)
@@ -53,6 +53,7 @@ extern uint64_t NUM_ALU_LANES;
 extern bool PREFETCHER_ENABLE;
 extern bool PERFECT_CACHE;
 extern bool WRITE_ALLOCATE;
+extern uint64_t CACHE_REPLACEMENT;
 
 extern uint64_t IC_SIZE;
 extern uint64_t IC_ASSOC;
@@ -82,10 +83,18 @@ extern uint64_t SLOW_ALU_EXEC_LATENCY;
 extern uint64_t LOG_LEVEL;
 extern uint64_t LOG_START_CYCLE;
 extern uint64_t LOG_END_CYCLE;
+extern const char *ACTIVITY_TRACE_FILE;
 
 extern uint64_t DQ_LATENCY;
 extern uint64_t MISP_REDUCTION_PERC;
 
 extern uint64_t EPOCH_SIZE_INSTS;
 extern bool PRINT_PER_EPOCH_STATS;
+
+extern bool TRACE_READAHEAD;
+extern uint64_t TRACE_START_INSTR;
+
+extern bool PREDICTOR_ONLY;
+extern uint64_t PREDICTOR_UPDATE_DELAY;
+extern const char *PREDICTOR_NAMES;
 #endif
@@ -0,0 +1,137 @@
+// Predictor Driver
+// See predictor_driver.h for a description.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "predictor_driver.h"
+#include "predictor_registry.h"
+#include "parameters.h"
+
+predictor_driver_t::predictor_driver_t(uint64_t update_delay, const std::vector<std::string> &pred_names)
+    : update_delay(update_delay)
+{
+   next_seq_no = 0;
+   num_uop = 0;
+   num_inst = 0;
+
+   assert(!pred_names.empty());
+   for (const std::string &name : pred_names)
+   {
+      lanes.emplace_back(new lane_t(name, create_registered_predictor(name)));
+   }
+
+   for (auto &lane : lanes)
+   {
+      lane->BP.notify_begin_new_epoch();
+   }
+}
+
+void predictor_driver_t::begin()
+{
+   for (auto &lane : lanes)
+   {
+      lane->BP.get_cond_dir_predictor().beginCondDirPredictor();
+      lane->subscription = lane->BP.get_cond_dir_predictor().get_notify_subscription();
+   }
+}
+
+void predictor_driver_t::end()
+{
+   for (auto &lane : lanes)
+   {
+      if (lanes.size() > 1)
+      {
+         printf("\n[%s]", lane->name.c_str());
+      }
+      lane->BP.get_cond_dir_predictor().endCondDirPredictor();
+   }
+}
+
+void predictor_driver_t::step(uint64_t seq_no, uint8_t piece, InstClass insn_class, bool taken, uint64_t pc, uint64_t next_pc)
+{
+   assert(seq_no >= next_seq_no);
+   const uint64_t skipped = seq_no - next_seq_no;
+   next_seq_no = seq_no + 1;
+
+   for (auto &lane_ptr : lanes)
+   {
+      lane_t &lane = *lane_ptr;
+      lane.BP.account_notctrl(skipped);
+
+      bool br_mispred = false;
+      if (!PERFECT_BRANCH_PRED)
+      {
+         br_mispred = lane.BP.predict(seq_no, piece, insn_class, pc, next_pc, seq_no);
+      }
+
+      if (!is_br(insn_class))
+      {
+         continue;
+      }
+
+      // Same predicted direction as the one uarchsim_t::step() records in the window.
+      bool pred_taken = true;
+      if (is_cond_br(insn_class))
+      {
+         pred_taken = br_mispred ? !taken : taken;
+      }
+      else
+      {
+         assert(taken);
+      }
+
+      ExecuteInfo exec_info;
+      exec_info.dec_info.insn_class = insn_class;
+      exec_info.taken.emplace(taken);
+      exec_info.next_pc = next_pc;
+
+      if (inst_class_in(lane.subscription.decode, insn_class))
+         lane.BP.get_cond_dir_predictor().notify_instr_decode(seq_no, piece, pc, exec_info.dec_info, seq_no);
+      // Branches the predictor is notified of neither at execute nor at commit are not queued.
+      if (inst_class_in(lane.subscription.execute | lane.subscription.commit, insn_class))
+         lane.pending.push_back({seq_no, piece, pc, pred_taken, exec_info});
+      update_pending(lane, seq_no, false);
+   }
+}
+
+void predictor_driver_t::update_pending(lane_t &lane, uint64_t cur_seq_no, bool drain)
+{
+   CondDirPredictor &pred = lane.BP.get_cond_dir_predictor();
+   while (!lane.pending.empty() && (drain || (lane.pending.front().seq_no + update_delay <= cur_seq_no)))
+   {
+      const pending_branch_t &br = lane.pending.front();
+      const InstClass insn_class = br.exec_info.dec_info.insn_class;
+      if (inst_class_in(lane.subscription.execute, insn_class))
+         pred.notify_instr_execute_resolve(br.seq_no, br.piece, br.pc, br.pred_taken, br.exec_info, cur_seq_no);
+      if (inst_class_in(lane.subscription.commit, insn_class))
+         pred.notify_instr_commit(br.seq_no, br.piece, br.pc, br.pred_taken, br.exec_info, cur_seq_no);
+      lane.pending.pop_front();
+   }
+}
+
+void predictor_driver_t::finish(uint64_t num_uop, uint64_t num_inst)
+{
+   assert(num_uop >= next_seq_no);
+   for (auto &lane : lanes)
+   {
+      lane->BP.account_notctrl(num_uop - next_seq_no);
+      update_pending(*lane, num_uop, true);
+   }
+   next_seq_no = num_uop;
+   this->num_uop = num_uop;
+   this->num_inst = num_inst;
+}
+
+void predictor_driver_t::output()
+{
+   printf("\nPredictor-only run: %lu instructions, %lu micro-ops\n", num_inst, num_uop);
+   for (auto &lane : lanes)
+   {
+      if (lanes.size() > 1)
+      {
+         printf("\n[%s]\n", lane->name.c_str());
+      }
+      lane->BP.output();
+   }
+}
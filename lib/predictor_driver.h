@@ -0,0 +1,81 @@
+// Predictor Driver
+//
+// Drives the branch predictor without the timing model of uarchsim_t: micro-ops are presented to bp_t::predict()
+// in program order, and each branch is decoded right after its prediction, then resolved and committed
+// update_delay micro-ops later (0: right after its prediction), in program order.
+// Used by cbp's predictor-only mode (-X predictor-only), and by branch-only replays (tools/cbp_replay.cc), where only
+// the micro-ops that can be mispredicted are presented and the others are accounted for by the gaps between seq_no's.
+// Since there is no timing model, the cycle passed to the predictor hooks is the seq_no of the micro-op being
+// presented, and DecodeInfo only holds the instruction class.
+//
+// The driver evaluates one or several registered predictors in one pass (cbp -X predictor-only -m <name>,<name>...):
+// each micro-op is presented to every lane, and each lane has its own predictor instance, bp_t measurements and
+// pending branches, so the lanes do not interfere and the trace is decoded once for all of them.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sim_common_structs.h"
+#include "cbp.h"
+#include "bp.h"
+
+class predictor_driver_t
+{
+private:
+   // Branches waiting for their resolve/commit notifications, oldest first.
+   struct pending_branch_t
+   {
+      uint64_t seq_no;
+      uint8_t piece;
+      uint64_t pc;
+      bool pred_taken;
+      ExecuteInfo exec_info;
+   };
+
+   struct lane_t
+   {
+      std::string name;
+      std::unique_ptr<CondDirPredictor> owned_pred;
+      bp_t BP;
+      std::deque<pending_branch_t> pending;
+      NotifySubscription subscription;     // read by begin()
+
+      lane_t(const std::string &name, CondDirPredictor *pred)
+          : name(name), owned_pred(pred), BP(pred)
+      {
+      }
+   };
+   std::vector<std::unique_ptr<lane_t>> lanes;
+
+   // seq_no expected for the next micro-op.
+   uint64_t next_seq_no;
+
+   uint64_t num_uop;
+   uint64_t num_inst;
+
+   uint64_t update_delay;
+
+   // Resolves and commits the pending branches of a lane predicted at least update_delay micro-ops before cur_seq_no.
+   void update_pending(lane_t &lane, uint64_t cur_seq_no, bool drain);
+
+public:
+   // One lane per name, each with a new instance of the registered predictor (exits on unknown names).
+   predictor_driver_t(uint64_t update_delay, const std::vector<std::string> &pred_names);
+
+   // Calls beginCondDirPredictor() (and reads get_notify_subscription()) / endCondDirPredictor() of every lane's predictor.
+   void begin();
+   void end();
+
+   // Presents one micro-op. Micro-ops skipped since the previous call are accounted for as non-control micro-ops.
+   void step(uint64_t seq_no, uint8_t piece, InstClass insn_class, bool taken, uint64_t pc, uint64_t next_pc);
+
+   // Accounts for the micro-ops after the last step() (num_uop is the total number of micro-ops),
+   // and resolves the branches still pending.
+   void finish(uint64_t num_uop, uint64_t num_inst);
+
+   void output();
+};
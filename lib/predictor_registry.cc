@@ -0,0 +1,69 @@
+// Predictor Registry
+// Predictors registered by name (see registerCondDirPredictor() in cbp.h).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include "predictor_registry.h"
+
+// Function-local, so that it is constructed before the static initializers that register predictors use it.
+static std::map<std::string, CondDirPredictorFactory> &registry()
+{
+   static std::map<std::string, CondDirPredictorFactory> factories;
+   return factories;
+}
+
+bool registerCondDirPredictor(const char *name, CondDirPredictorFactory factory)
+{
+   registry()[name] = factory;
+   return true;
+}
+
+CondDirPredictor *createCondDirPredictor(const std::string &name)
+{
+   auto it = registry().find(name);
+   return (it == registry().end()) ? nullptr : it->second();
+}
+
+std::vector<std::string> listCondDirPredictors()
+{
+   std::vector<std::string> names;
+   for (const auto &entry : registry())
+   {
+      names.push_back(entry.first);
+   }
+   return names;
+}
+
+CondDirPredictor *create_registered_predictor(const std::string &name)
+{
+   CondDirPredictor *pred = createCondDirPredictor(name);
+   if (pred == nullptr)
+   {
+      printf("Unknown predictor: %s (registered:", name.c_str());
+      for (const std::string &registered : listCondDirPredictors())
+      {
+         printf(" %s", registered.c_str());
+      }
+      printf(")\n");
+      exit(0);
+   }
+   return pred;
+}
+
+std::vector<std::string> split_predictor_names(const char *names)
+{
+   std::vector<std::string> split;
+   while (names && *names)
+   {
+      const char *comma = strchr(names, ',');
+      const size_t len = comma ? (size_t)(comma - names) : strlen(names);
+      if (len)
+      {
+         split.emplace_back(names, len);
+      }
+      names += comma ? len + 1 : len;
+   }
+   return split;
+}
@@ -0,0 +1,16 @@
+// Predictor Registry
+//
+// Helpers for the simulator and tools that select registered predictors by name (cbp -m, cbp_replay).
+// Predictors register themselves with registerCondDirPredictor() (see cbp.h).
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "cbp.h"
+
+// Returns a new instance of the predictor registered under name. Exits, listing the registered predictors, if there is none.
+CondDirPredictor *create_registered_predictor(const std::string &name);
+
+// Splits a comma-separated list of predictor names.
+std::vector<std::string> split_predictor_names(const char *names);
@@ -29,64 +29,70 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 resource_schedule::resource_schedule(uint64_t width) {
    base_cycle = 0;
    this->width = width;
-   depth = SCHED_DEPTH_INCREMENT;
-   sched = new uint64_t[depth];
-   for (uint64_t i = 0; i < depth; i++)
-      sched[i] = 0;
+   depth = SCHED_INITIAL_DEPTH;
+   sched.assign(depth, 0);
+   full.assign(depth / 64, 0);
 }
 
 resource_schedule::~resource_schedule() {
 }
 
+// Grows the schedule to at least new_depth cycles. Cycles keep their lane counts, at their new position.
 void resource_schedule::resize(uint64_t new_depth) {
-   uint64_t old_depth;
-   uint64_t *old;
-   uint64_t increments;
-   uint64_t i;
-
-   old_depth = depth;
-   old = sched;
-
-   increments = (new_depth/SCHED_DEPTH_INCREMENT);
-   if (new_depth % SCHED_DEPTH_INCREMENT)
-      increments++;
-   depth = increments*SCHED_DEPTH_INCREMENT;
-   assert(depth >= new_depth);
-
-   sched = new uint64_t[depth];
-   for (i = 0; i < old_depth; i++)
-      sched[i] = old[i];
-   for (i = old_depth; i < depth; i++)
-      sched[i] = 0;
-
-   delete[] old;
+   uint64_t old_depth = depth;
+   while (depth < new_depth)
+      depth <<= 1;
+
+   std::vector<uint64_t> old;
+   old.swap(sched);
+   sched.assign(depth, 0);
+   full.assign(depth / 64, 0);
+   for (uint64_t cycle = base_cycle; cycle < base_cycle + old_depth; cycle++) {
+      const uint64_t pos = MOD_S(cycle, depth);
+      sched[pos] = old[MOD_S(cycle, old_depth)];
+      if (sched[pos] >= width)
+         full[pos / 64] |= (1lu << (pos % 64));
+   }
 }
 
-uint64_t resource_schedule::schedule(uint64_t start_cycle, uint64_t max_delta) 
+uint64_t resource_schedule::find_free(uint64_t start_cycle, uint64_t limit_cycle)
 {
    assert(start_cycle >= base_cycle);
-
-   uint64_t limit_cycle = max_delta == MAX_CYCLE ? MAX_CYCLE : start_cycle + max_delta;
-   bool found = false;
-
-   while (!found) {
-      if ((start_cycle - base_cycle + 1) > depth)
-         resize(start_cycle - base_cycle + 1);
-
-      if (sched[MOD_S(start_cycle,depth)] < width) {
-         found = true;
-         sched[MOD_S(start_cycle,depth)]++;
-      }
-      else {
-         start_cycle++;
-         if(start_cycle > limit_cycle)
-         {
-            return MAX_CYCLE;
-         }
-      }
+   uint64_t cycle = start_cycle;
+   while (cycle <= limit_cycle) {
+      if ((cycle - base_cycle + 1) > depth)
+         resize(cycle - base_cycle + 1);
+
+      // Bits past the end of the schedule (base_cycle + depth) are those of earlier cycles: the cycles there
+      // are only looked at after growing the schedule.
+      const uint64_t end_cycle = base_cycle + depth;
+      const uint64_t pos = MOD_S(cycle, depth);
+      const uint64_t free_bits = ~full[pos / 64] >> (pos % 64);
+      const uint64_t free_cycle = free_bits ? (cycle + __builtin_ctzl(free_bits)) : (cycle + 64 - (pos % 64));
+      if (free_cycle >= end_cycle)
+         cycle = end_cycle;
+      else if (free_bits)
+         return ((free_cycle <= limit_cycle) ? free_cycle : MAX_CYCLE);
+      else
+         cycle = free_cycle;
    }
+   return MAX_CYCLE;
+}
+
+uint64_t resource_schedule::schedule(uint64_t start_cycle, uint64_t max_delta)
+{
+   assert(start_cycle >= base_cycle);
+   uint64_t limit_cycle = (max_delta > MAX_CYCLE - start_cycle) ? MAX_CYCLE : start_cycle + max_delta;
+
+   start_cycle = find_free(start_cycle, limit_cycle);
+   if (start_cycle == MAX_CYCLE)
+      return MAX_CYCLE;
 
-   assert(found);
+   const uint64_t pos = MOD_S(start_cycle, depth);
+   assert(sched[pos] < width);
+   sched[pos]++;
+   if (sched[pos] == width)
+      full[pos / 64] |= (1lu << (pos % 64));
    return(start_cycle);
 }
 
@@ -94,29 +100,19 @@ uint64_t resource_schedule::try_schedule(uint64_t try_cycle)
 {
    // Calling this assumes all previous events to schedule have been scheduled.
    assert(try_cycle >= base_cycle);
-
-   bool found = false;
-
-   while (!found) {
-      if ((try_cycle - base_cycle + 1) > depth)
-         resize(try_cycle - base_cycle + 1);
-
-      if (sched[MOD_S(try_cycle,depth)] < width) {
-         found = true;
-      }
-      else {
-         try_cycle++;
-      }
-   }
-
-   assert(found);
+   try_cycle = find_free(try_cycle, MAX_CYCLE);
+   assert(try_cycle != MAX_CYCLE);
    return(try_cycle);
 }
 
 void resource_schedule::advance_base_cycle(uint64_t new_base_cycle) {
    assert(new_base_cycle >= base_cycle);
-   for (uint64_t i = base_cycle; i < new_base_cycle; i++)
-      sched[MOD_S(i,depth)] = 0;
+   // Every slot is reset at most once, however far the base cycle moves.
+   const uint64_t end_cycle = ((new_base_cycle - base_cycle) > depth) ? (base_cycle + depth) : new_base_cycle;
+   for (uint64_t i = base_cycle; i < end_cycle; i++) {
+      const uint64_t pos = MOD_S(i, depth);
+      sched[pos] = 0;
+      full[pos / 64] &= ~(1lu << (pos % 64));
+   }
    base_cycle = new_base_cycle;
 }
-
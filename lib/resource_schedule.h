@@ -22,24 +22,33 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 
 
-#define SCHED_DEPTH_INCREMENT 256
+#include <cstdint>
+#include <vector>
+
+// Lanes used per cycle, for cycles base_cycle to base_cycle + depth - 1, in a circular array indexed by cycle
+// modulo depth (a power of two, doubled when a cycle past that is scheduled). A bitmap of the full cycles
+// (one bit per cycle, same indexing) lets the search for a cycle with a free lane skip 64 full cycles at a time.
+#define SCHED_INITIAL_DEPTH 256
 #define MOD_S(x,y)      ((x) & ((y)-1))
 
 constexpr uint64_t MAX_CYCLE = ~0lu;
 
 class resource_schedule {
 private:
-   uint64_t *sched;
+   std::vector<uint64_t> sched;
+   std::vector<uint64_t> full;   // one bit per cycle: all lanes used
    uint64_t depth;
    uint64_t width;
-
    uint64_t base_cycle;
 
    void resize(uint64_t new_depth);
+   // First cycle from start_cycle to limit_cycle with a free lane, or MAX_CYCLE if none.
+   uint64_t find_free(uint64_t start_cycle, uint64_t limit_cycle);
 
 public:
    resource_schedule(uint64_t width);
    ~resource_schedule();
+
    uint64_t schedule(uint64_t start_cycle, uint64_t max_delta = MAX_CYCLE);
    uint64_t try_schedule(uint64_t try_cycle);
    void advance_base_cycle(uint64_t new_base_cycle);
@@ -25,6 +25,9 @@
 #include <optional>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <type_traits>
 
 enum class InstClass : uint8_t
 {
@@ -94,10 +97,33 @@ enum class HitMissInfo : uint8_t
     Invalid
 };
 
+// Source registers of a micro-op (at most 3), stored inline. Offers the parts of the std::vector interface
+// predictors use (size, operator[], iteration), so DecodeInfo and ExecuteInfo stay trivially copyable.
+struct SrcRegInfo
+{
+    static constexpr uint8_t max_size = 3;
+    uint8_t num_regs = 0;
+    uint64_t regs[max_size];
+
+    size_t size() const { return num_regs; }
+    bool empty() const { return num_regs == 0; }
+    uint64_t operator[](size_t i) const { return regs[i]; }
+    uint64_t at(size_t i) const { assert(i < num_regs); return regs[i]; }
+    const uint64_t *begin() const { return regs; }
+    const uint64_t *end() const { return regs + num_regs; }
+    void clear() { num_regs = 0; }
+    void push_back(uint64_t reg)
+    {
+        assert(num_regs < max_size);
+        regs[num_regs++] = reg;
+    }
+    std::vector<uint64_t> to_vector() const { return std::vector<uint64_t>(begin(), end()); }
+};
+
 struct DecodeInfo
 {
     InstClass insn_class;
-    std::vector<uint64_t> src_reg_info;
+    SrcRegInfo src_reg_info;
     std::optional<uint64_t> dst_reg_info;
     //std::optional<uint64_t> imm_op;
     DecodeInfo()
@@ -137,3 +163,6 @@ struct ExecuteInfo
         dst_reg_value.reset();
     }
 };
+
+static_assert(std::is_trivially_copyable<DecodeInfo>::value && std::is_trivially_copyable<ExecuteInfo>::value,
+              "DecodeInfo/ExecuteInfo are copied per micro-op");
@@ -0,0 +1,147 @@
+// Store queue byte timestamps, for store-to-load forwarding.
+//
+// For every byte, the youngest store to it: its execution cycle and its commit cycle (ret_cycle). A load
+// byte hits in the SQ if the load searches it before that store's ret_cycle.
+//
+// Bytes are grouped in aligned 8-byte words, kept in an open-addressed (linear probing) hash table with a
+// mask of the bytes written, so a load or store of up to 8 bytes takes one or two probes. A word is dead once
+// the ret_cycle of all its bytes has passed: no later load can hit on it. Dead words are reset by the next
+// store to them and dropped whenever the table is rebuilt (when half of its slots have been used), so the
+// table stays about the size of the stores in flight rather than of the program's store footprint.
+
+#ifndef _STORE_QUEUE_H
+#define _STORE_QUEUE_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#define SQ_WORD_BYTES 8
+
+class store_queue_t {
+private:
+   struct word_t {
+      uint64_t word;                           // addr / SQ_WORD_BYTES, or UINT64_MAX for a free slot
+      uint64_t max_ret_cycle;                  // latest ret_cycle of the word's bytes
+      uint8_t mask;                            // bytes written
+      uint64_t exec_cycle[SQ_WORD_BYTES];
+      uint64_t ret_cycle[SQ_WORD_BYTES];
+   };
+
+   std::vector<word_t> table;
+   uint64_t mask;
+   uint64_t num_used;                          // slots that are not free, live or dead
+
+   static uint64_t hash(uint64_t word)
+   {
+      return (word * 0x9e3779b97f4a7c15lu) >> 20;
+   }
+
+   // Slot of word, or of the free slot ending its probe sequence.
+   word_t &find(uint64_t word)
+   {
+      uint64_t i = hash(word) & mask;
+      while ((table[i].word != word) && (table[i].word != UINT64_MAX))
+         i = (i + 1) & mask;
+      return table[i];
+   }
+
+   // Rebuilds the table with only the words still live at cycle now, growing it if they fill a quarter of it.
+   void rebuild(uint64_t now)
+   {
+      std::vector<word_t> old;
+      old.swap(table);
+
+      uint64_t num_live = 0;
+      for (const word_t &w : old)
+         num_live += ((w.word != UINT64_MAX) && (w.max_ret_cycle > now));
+      uint64_t capacity = old.size();
+      while (num_live > capacity / 4)
+         capacity *= 2;
+
+      table.assign(capacity, word_t{UINT64_MAX, 0, 0, {}, {}});
+      mask = capacity - 1;
+      num_used = num_live;
+      for (const word_t &w : old)
+         if ((w.word != UINT64_MAX) && (w.max_ret_cycle > now))
+            find(w.word) = w;
+   }
+
+public:
+   store_queue_t(uint64_t capacity)
+   {
+      uint64_t size = 64;
+      while (size < capacity)
+         size *= 2;
+      table.assign(size, word_t{UINT64_MAX, 0, 0, {}, {}});
+      mask = size - 1;
+      num_used = 0;
+   }
+
+   // Records a store. now is a cycle no later load searches the SQ at or before (the current fetch cycle).
+   void store(uint64_t addr, uint64_t size, uint64_t exec_cycle, uint64_t ret_cycle, uint64_t now)
+   {
+      if (size == 0)
+         return;
+      for (uint64_t word = addr / SQ_WORD_BYTES; word <= (addr + size - 1) / SQ_WORD_BYTES; word++)
+      {
+         if (2 * (num_used + 1) > table.size())
+            rebuild(now);
+
+         word_t &w = find(word);
+         if (w.word == UINT64_MAX)
+         {
+            num_used++;
+            w.word = word;
+            w.mask = 0;
+            w.max_ret_cycle = 0;
+         }
+         else if (w.max_ret_cycle <= now)
+         {
+            w.mask = 0;   // dead: none of its bytes can hit anymore
+            w.max_ret_cycle = 0;
+         }
+
+         const uint64_t first = (word == addr / SQ_WORD_BYTES) ? (addr % SQ_WORD_BYTES) : 0;
+         const uint64_t last = (word == (addr + size - 1) / SQ_WORD_BYTES) ? ((addr + size - 1) % SQ_WORD_BYTES) : (SQ_WORD_BYTES - 1);
+         for (uint64_t b = first; b <= last; b++)
+         {
+            w.mask |= (1 << b);
+            w.exec_cycle[b] = exec_cycle;
+            w.ret_cycle[b] = ret_cycle;
+         }
+         w.max_ret_cycle = (ret_cycle > w.max_ret_cycle) ? ret_cycle : w.max_ret_cycle;
+      }
+   }
+
+   // Searches the SQ for a load of size bytes at addr, at cycle search_cycle. Returns true if all bytes hit, and
+   // sets fwd_cycle to the latest of search_cycle and the hitting stores' execution cycles (0 if no byte hits).
+   bool load(uint64_t addr, uint64_t size, uint64_t search_cycle, uint64_t &fwd_cycle)
+   {
+      bool all_hit = true;
+      fwd_cycle = 0;
+      if (size == 0)
+         return all_hit;
+      for (uint64_t word = addr / SQ_WORD_BYTES; word <= (addr + size - 1) / SQ_WORD_BYTES; word++)
+      {
+         const word_t &w = find(word);
+         const uint64_t first = (word == addr / SQ_WORD_BYTES) ? (addr % SQ_WORD_BYTES) : 0;
+         const uint64_t last = (word == (addr + size - 1) / SQ_WORD_BYTES) ? ((addr + size - 1) % SQ_WORD_BYTES) : (SQ_WORD_BYTES - 1);
+         for (uint64_t b = first; b <= last; b++)
+         {
+            if ((w.word == word) && (w.mask & (1 << b)) && (search_cycle < w.ret_cycle[b]))
+            {
+               const uint64_t cycle = (w.exec_cycle[b] > search_cycle) ? w.exec_cycle[b] : search_cycle;
+               fwd_cycle = (cycle > fwd_cycle) ? cycle : fwd_cycle;
+            }
+            else
+            {
+               all_hit = false;
+            }
+         }
+      }
+      return all_hit;
+   }
+};
+
+#endif
@@ -2,9 +2,9 @@
 
 #include <cassert>
 #include <vector>
-#include <deque>
 #include <map>
 #include <algorithm>
+#include <functional>
 //#include <optional>
 
 #define DEF_ENUM(ENUM, NAME) _DEF_ENUM(ENUM, NAME)
@@ -53,7 +53,11 @@ static std::ostream& operator<<(std::ostream& stream, const PrefetcherState& s)
     return stream;
 }
 
+// The RPT is set-associative, indexed by a hash of the load PC, with LRU replacement within a set.
 constexpr uint64_t NUM_RPT_ENTRIES = 1024;
+constexpr uint64_t RPT_ASSOC = 16;
+constexpr uint64_t NUM_RPT_SETS = NUM_RPT_ENTRIES / RPT_ASSOC;
+static_assert((NUM_RPT_SETS & (NUM_RPT_SETS - 1)) == 0, "The number of RPT sets must be a power of two");
 constexpr uint64_t PREFETCH_MULTIPLIER = 2; // 2 because when we lookahead, we are 1 behind, so need next(next(access))
 constexpr int PF_QUEUE_SIZE = 32;
 constexpr uint64_t CACHE_LINE_MASK = ~63lu;
@@ -115,51 +119,88 @@ struct Prefetch
     uint64_t address = 0xdeadbeef;
     uint64_t cycle_generated = ~0lu;
     //CacheLevel level;
+
+    // Issue order of the PF queue: by generation order from oldest to youngest, then by address.
+    bool operator>(const Prefetch & rhs) const
+    {
+        if(cycle_generated != rhs.cycle_generated)
+        {
+            return cycle_generated > rhs.cycle_generated;
+        }
+        return address > rhs.address;
+    }
 };
 
 class StridePrefetcher
 {
    public:
-    void init(const uint64_t n)
+    void init()
     {
-        for(uint64_t i = 0; i < n; i++)
+        for(uint64_t i = 0; i < NUM_RPT_ENTRIES; i++)
         {
-            //Initialize LRU
+            //Initialize LRU: within a set, the last way is the first victim
+            rpt[i] = RPTEntry();
             rpt[i].index = i;
-            rpt[i].lru = i;
+            rpt[i].lru = RPT_ASSOC - 1 - (i % RPT_ASSOC);
         }
+        lru_clock = RPT_ASSOC;
         //Clear queue of generated prefetches
         queue.clear();
     }
 
     StridePrefetcher()
     {
-        init(NUM_RPT_ENTRIES);
+        init();
+    }
+
+    // First way of the set of a load PC.
+    static uint64_t set_base(uint64_t pc)
+    {
+        return ((pc ^ (pc >> 6) ^ (pc >> 12)) & (NUM_RPT_SETS - 1)) * RPT_ASSOC;
     }
 
-    uint64_t victim_way()
+    RPTEntry* find(uint64_t pc)
     {
-        auto entry = std::find_if(rpt.begin(), rpt.end(), [](RPTEntry& e){ return !e.lru; });
-        assert((entry != rpt.end()) && "Must find a valid victim way ");
-        spdlog::debug("Prefetch: Found victim entry : {}", *entry);
+        RPTEntry* set = &rpt[set_base(pc)];
+        for(uint64_t way = 0; way < RPT_ASSOC; way++)
+        {
+            if((set[way].tag == pc) && (set[way].state != PrefetcherState::Invalid))
+            {
+                return &set[way];
+            }
+        }
+        return nullptr;
+    }
+
+    // Least recently used way of the set of pc (the lru field is the last use stamp).
+    uint64_t victim_way(uint64_t pc)
+    {
+        const uint64_t base = set_base(pc);
+        uint64_t victim = base;
+        for(uint64_t i = base + 1; i < base + RPT_ASSOC; i++)
+        {
+            if(rpt[i].lru < rpt[victim].lru)
+            {
+                victim = i;
+            }
+        }
+        spdlog::debug("Prefetch: Found victim entry : {}", rpt[victim]);
 
-        return entry->index;
+        return victim;
     }
 
     void update_lru(uint64_t index)
     {
         spdlog::debug("Updating LRU Index: {}", index);
-        auto& lru_way = rpt[index];
-        std::for_each(rpt.begin(), rpt.end(), [&lru_way](RPTEntry &e) { if(e.lru > lru_way.lru){ --e.lru;} });
-        lru_way.lru = (NUM_RPT_ENTRIES - 1);
+        rpt[index].lru = lru_clock++;
     }
 
     // Prefetches will be generated when the load is fetched as in "Effective Hardware-Based Data Prefetching for High-Performance Processors"
     // However because we train immediately, there is no need for a count variable.
     void lookahead(uint64_t la_pc, uint64_t cycle)
     {
-        auto entry = std::find_if(rpt.begin(), rpt.end(), [la_pc](RPTEntry& e){ return e.tag == la_pc; });
-        if(entry == rpt.end())
+        auto entry = find(la_pc);
+        if(entry == nullptr)
         {
             return;
         }
@@ -172,11 +213,11 @@ class StridePrefetcher
     void train(const PrefetchTrainingInfo & info)
     {
         spdlog::debug("Prefetcher: Training on LD {}", info);
-        auto entry = std::find_if(rpt.begin(), rpt.end(), [&info](RPTEntry& e){ return e.tag == info.pc; });
-        if(entry == rpt.end())
+        auto entry = find(info.pc);
+        if(entry == nullptr)
         {
             //Establish a new entry
-            auto victim_index = victim_way();
+            auto victim_index = victim_way(info.pc);
             auto& victim_entry = rpt[victim_index];
             victim_entry.state = PrefetcherState::Initial;
             victim_entry.tag = info.pc;
@@ -301,22 +342,7 @@ class StridePrefetcher
 
         if(it == queue.end())
         {
-            queue.push_back(pf);
-            
-            // Make extra sure PF are sorted by generation order from oldest to youngest
-            std::sort(queue.begin(), queue.end(), [](const Prefetch & lhs, const Prefetch & rhs)
-            {
-                if(lhs.cycle_generated != rhs.cycle_generated)
-                {
-                    return lhs.cycle_generated < rhs.cycle_generated;
-                }
-                if(lhs.address != rhs.address)
-                {
-                    return lhs.address < rhs.address;
-                }
-                return false;
-            });
-
+            push(pf);
             ++stat_generated;
         }
         else
@@ -333,7 +359,7 @@ class StridePrefetcher
         {
             spdlog::debug("Dropping pf because too old (created at cycle {}, current fetch cycle {})", queue.front().cycle_generated, cycle);
             ++stat_dropped_untimely_pf;
-            queue.pop_front();
+            pop();
         }
 
         if(!queue.empty())
@@ -341,7 +367,7 @@ class StridePrefetcher
             p = queue.front();
             if(p.cycle_generated <= cycle)
             {
-                queue.pop_front();
+                pop();
                 ++stat_issued;
                 return true;
             }
@@ -354,7 +380,7 @@ class StridePrefetcher
     void put_back(const Prefetch & p)
     {
         ++stat_put_back;
-        queue.push_front(p);
+        push(p);
     }
 
     uint64_t get_oldest_pf_cycle() const
@@ -380,11 +406,25 @@ class StridePrefetcher
         std::cout << "Num prefetches not issued stride 0 :" << stat_stride_zero << std::endl;
     }
     private:
+    // Way w of set s is rpt[s * RPT_ASSOC + w].
     std::array<RPTEntry, NUM_RPT_ENTRIES> rpt;
-    uint64_t lru_info;
+    uint64_t lru_clock;
+
+    //Queue to store generated prefetches: a binary min-heap in issue order (front() is the next to issue)
+    std::vector<Prefetch> queue;
+
+    void push(const Prefetch & p)
+    {
+        queue.push_back(p);
+        std::push_heap(queue.begin(), queue.end(), std::greater<Prefetch>());
+    }
+
+    void pop()
+    {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<Prefetch>());
+        queue.pop_back();
+    }
 
-    //Queue to store generated prefetches
-    std::deque<Prefetch> queue;
     //Stats
     uint64_t stat_trainings = 0;
     uint64_t stat_generated = 0;
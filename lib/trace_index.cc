@@ -0,0 +1,362 @@
+// CBP Trace Index
+// See trace_index.h for a description.
+
+#include <algorithm>
+#include <cassert>
+#include "trace_index.h"
+#include "trace_reader.h"
+
+// Size of the trace record starting at p, or 0 if the avail bytes do not hold the whole record.
+// Follows the trace format parsed by TraceReader::decodeGzInstr().
+static size_t trace_record_size(const uint8_t * p, size_t avail)
+{
+    size_t off = sizeof(uint64_t) + sizeof(uint8_t);
+    if(avail < off)
+        return 0;
+
+    const InstClass type = static_cast<InstClass>(p[sizeof(uint64_t)]);
+    if(is_mem(type))
+    {
+        off += sizeof(uint64_t) + 2 * sizeof(uint8_t);
+        if(is_store(type))
+            off += sizeof(uint8_t);
+    }
+    if(is_br(type))
+    {
+        if(avail < off + 1)
+            return 0;
+        const bool taken = p[off];
+        off += 1;
+        if(taken)
+            off += sizeof(uint64_t);
+    }
+
+    if(avail < off + 1)
+        return 0;
+    off += 1 + p[off];
+
+    if(avail < off + 1)
+        return 0;
+    const uint8_t num_out_regs = p[off];
+    const uint8_t * out_regs = p + off + 1;
+    off += 1 + num_out_regs;
+    if(avail < off)
+        return 0;
+    for(auto i = 0; i != num_out_regs; i++)
+    {
+        off += reg_is_int(out_regs[i]) ? sizeof(uint64_t) : 2 * sizeof(uint64_t);
+    }
+
+    return (avail >= off) ? off : 0;
+}
+
+// Index file layout: header, then one window per access point, then the access point table.
+static uint64_t window_offset(uint64_t point_idx)
+{
+    return sizeof(trace_index_header_t) + point_idx * TRACE_INDEX_WINDOW_SIZE;
+}
+
+bool build_trace_index(const char * trace_name, const char * index_name, uint64_t span)
+{
+    FILE * in = fopen(trace_name, "rb");
+    if(in == nullptr)
+    {
+        fprintf(stderr, "Cannot open trace %s\n", trace_name);
+        return false;
+    }
+    FILE * out = fopen(index_name, "wb");
+    if(out == nullptr)
+    {
+        fprintf(stderr, "Cannot create trace index %s\n", index_name);
+        fclose(in);
+        return false;
+    }
+
+    trace_index_header_t header = {};
+    memcpy(header.magic, TRACE_INDEX_MAGIC, sizeof(TRACE_INDEX_MAGIC));
+    header.version = TRACE_INDEX_VERSION;
+    header.span = span;
+    fwrite(&header, sizeof(header), 1, out);
+
+    z_stream strm = {};
+    // 47: inflate a gzip or zlib stream, with the largest window.
+    if(inflateInit2(&strm, 47) != Z_OK)
+    {
+        fprintf(stderr, "inflateInit2 failed\n");
+        fclose(in);
+        fclose(out);
+        return false;
+    }
+
+    std::vector<uint8_t> input(1 << 16);
+    std::vector<uint8_t> window(TRACE_INDEX_WINDOW_SIZE);
+    std::vector<uint8_t> saved_window(TRACE_INDEX_WINDOW_SIZE);
+    std::vector<trace_index_point_t> points;
+
+    // Inflated bytes not parsed into records yet, and the inflated offset of pending[0].
+    std::vector<uint8_t> pending;
+    uint64_t pending_out = 0;
+
+    uint64_t totin = 0;
+    uint64_t totout = 0;
+    uint64_t last = 0;
+    uint64_t num_instr = 0;
+    size_t first_unresolved = 0;
+    int ret = Z_OK;
+    bool ok = true;
+
+    do
+    {
+        if(strm.avail_in == 0)
+        {
+            strm.avail_in = fread(input.data(), 1, input.size(), in);
+            if(strm.avail_in == 0)
+            {
+                fprintf(stderr, "%s: unexpected end of gz stream\n", trace_name);
+                ok = false;
+                break;
+            }
+            strm.next_in = input.data();
+        }
+        if(strm.avail_out == 0)
+        {
+            strm.avail_out = window.size();
+            strm.next_out = window.data();
+        }
+
+        // Inflate until the end of a deflate block, or until the input or output buffer is exhausted.
+        const uint8_t * out_start = strm.next_out;
+        totin += strm.avail_in;
+        totout += strm.avail_out;
+        ret = inflate(&strm, Z_BLOCK);
+        totin -= strm.avail_in;
+        totout -= strm.avail_out;
+        if(ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR)
+        {
+            fprintf(stderr, "%s: corrupt gz stream (%s)\n", trace_name, strm.msg ? strm.msg : "inflate error");
+            ok = false;
+            break;
+        }
+
+        // Parse the complete records, resolving the access points that precede them.
+        pending.insert(pending.end(), out_start, (const uint8_t*)strm.next_out);
+        size_t pos = 0;
+        while(const size_t rec_size = trace_record_size(pending.data() + pos, pending.size() - pos))
+        {
+            const uint64_t rec_out = pending_out + pos;
+            for(; first_unresolved != points.size() && points[first_unresolved].out <= rec_out; first_unresolved++)
+            {
+                points[first_unresolved].instr_num = num_instr;
+                points[first_unresolved].instr_out = rec_out;
+            }
+            num_instr++;
+            pos += rec_size;
+        }
+        pending.erase(pending.begin(), pending.begin() + pos);
+        pending_out += pos;
+
+        // Add an access point at the end of a non-last deflate block, every span bytes of output.
+        if(ret != Z_STREAM_END && (strm.data_type & 128) && !(strm.data_type & 64) && (totout == 0 || totout - last >= span))
+        {
+            trace_index_point_t point = {};
+            point.bits = strm.data_type & 7;
+            point.in = totin;
+            point.out = totout;
+            points.push_back(point);
+
+            // The last 32KB of output, from the circular window.
+            const size_t left = strm.avail_out;
+            if(left)
+                memcpy(saved_window.data(), window.data() + window.size() - left, left);
+            if(left < window.size())
+                memcpy(saved_window.data() + left, window.data(), window.size() - left);
+            fwrite(saved_window.data(), 1, saved_window.size(), out);
+            last = totout;
+        }
+    } while(ret != Z_STREAM_END);
+
+    inflateEnd(&strm);
+    fclose(in);
+
+    // Access points past the last instruction (if any) position the input at the end of the trace.
+    for(; first_unresolved != points.size(); first_unresolved++)
+    {
+        points[first_unresolved].instr_num = num_instr;
+        points[first_unresolved].instr_out = totout;
+    }
+
+    header.num_points = points.size();
+    header.num_instr = num_instr;
+    fwrite(points.data(), sizeof(trace_index_point_t), points.size(), out);
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+    ok &= !ferror(out);
+    fclose(out);
+
+    if(!ok)
+    {
+        remove(index_name);
+    }
+    return ok;
+}
+
+bool trace_index::load(const char * index_name)
+{
+    FILE * f = fopen(index_name, "rb");
+    if(f == nullptr)
+        return false;
+
+    bool ok = fread(&header, sizeof(header), 1, f) == 1
+              && memcmp(header.magic, TRACE_INDEX_MAGIC, sizeof(TRACE_INDEX_MAGIC)) == 0
+              && header.version == TRACE_INDEX_VERSION
+              && header.num_points != 0;
+    if(ok)
+    {
+        points.resize(header.num_points);
+        ok = fseek(f, window_offset(header.num_points), SEEK_SET) == 0
+             && fread(points.data(), sizeof(trace_index_point_t), points.size(), f) == points.size();
+    }
+    fclose(f);
+
+    name = index_name;
+    return ok;
+}
+
+const trace_index_point_t& trace_index::find(uint64_t instr) const
+{
+    assert(!points.empty());
+    auto it = std::upper_bound(points.begin(), points.end(), instr,
+                               [](uint64_t i, const trace_index_point_t& p) { return i < p.instr_num; });
+    return (it == points.begin()) ? points.front() : *(it - 1);
+}
+
+bool trace_index::read_window(const trace_index_point_t& point, uint8_t * window) const
+{
+    FILE * f = fopen(name.c_str(), "rb");
+    if(f == nullptr)
+        return false;
+
+    const uint64_t point_idx = &point - points.data();
+    const bool ok = fseek(f, window_offset(point_idx), SEEK_SET) == 0
+                    && fread(window, 1, TRACE_INDEX_WINDOW_SIZE, f) == TRACE_INDEX_WINDOW_SIZE;
+    fclose(f);
+    return ok;
+}
+
+trace_seek_input::trace_seek_input(const char * trace_name, const trace_index& index, uint64_t start_instr)
+    : file(nullptr)
+    , strm()
+    , strm_init(false)
+    , stream_end(false)
+    , start_point_instr(0)
+    , cur_ptr(nullptr)
+    , cur_end(nullptr)
+    , at_eof(false)
+{
+    const trace_index_point_t& point = index.find(start_instr);
+    std::unique_ptr<uint8_t[]> window(new uint8_t[TRACE_INDEX_WINDOW_SIZE]);
+    if(!index.read_window(point, window.get()))
+        return;
+
+    file = fopen(trace_name, "rb");
+    if(file == nullptr)
+        return;
+
+    in_buffer.reset(new uint8_t[IN_BUFFER_SIZE]);
+    out_buffer.reset(new char[OUT_BUFFER_SIZE]);
+
+    // Raw inflate, resuming in the middle of the deflate stream.
+    if(inflateInit2(&strm, -15) != Z_OK)
+    {
+        fclose(file);
+        file = nullptr;
+        return;
+    }
+    strm_init = true;
+
+    fseeko(file, point.in - (point.bits ? 1 : 0), SEEK_SET);
+    if(point.bits)
+    {
+        const int byte = getc(file);
+        inflatePrime(&strm, point.bits, byte >> (8 - point.bits));
+    }
+    inflateSetDictionary(&strm, window.get(), TRACE_INDEX_WINDOW_SIZE);
+    start_point_instr = point.instr_num;
+
+    // Skip the tail of the instruction that straddles the access point.
+    uint64_t skip = point.instr_out - point.out;
+    while(skip != 0)
+    {
+        if(cur_ptr == cur_end && !refill())
+            break;
+        const size_t chunk = std::min<uint64_t>(skip, cur_end - cur_ptr);
+        cur_ptr += chunk;
+        skip -= chunk;
+    }
+}
+
+trace_seek_input::~trace_seek_input()
+{
+    if(strm_init)
+        inflateEnd(&strm);
+    if(file)
+        fclose(file);
+}
+
+// Inflates the next chunk of the trace into out_buffer. Returns false at the end of the deflate stream.
+bool trace_seek_input::refill()
+{
+    if(stream_end)
+        return false;
+
+    strm.next_out = reinterpret_cast<Bytef*>(out_buffer.get());
+    strm.avail_out = OUT_BUFFER_SIZE;
+    while(strm.avail_out != 0)
+    {
+        if(strm.avail_in == 0)
+        {
+            strm.avail_in = fread(in_buffer.get(), 1, IN_BUFFER_SIZE, file);
+            strm.next_in = in_buffer.get();
+            if(strm.avail_in == 0)
+            {
+                stream_end = true;
+                break;
+            }
+        }
+        const int ret = inflate(&strm, Z_NO_FLUSH);
+        if(ret != Z_OK)
+        {
+            // Z_STREAM_END, or a corrupt trace that is treated as its end.
+            stream_end = true;
+            break;
+        }
+    }
+
+    cur_ptr = out_buffer.get();
+    cur_end = cur_ptr + (OUT_BUFFER_SIZE - strm.avail_out);
+    return cur_ptr != cur_end;
+}
+
+// Slow path of read(): the requested bytes straddle the end of out_buffer.
+void trace_seek_input::read_slow(char * dst, size_t n)
+{
+    while(n != 0)
+    {
+        const size_t avail = cur_end - cur_ptr;
+        if(avail == 0)
+        {
+            if(!refill())
+            {
+                at_eof = true;
+                return;
+            }
+            continue;
+        }
+
+        const size_t chunk = std::min(avail, n);
+        memcpy(dst, cur_ptr, chunk);
+        cur_ptr += chunk;
+        dst += chunk;
+        n -= chunk;
+    }
+}
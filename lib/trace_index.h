@@ -0,0 +1,151 @@
+// CBP Trace Index
+//
+// Random access into gz traces, in the style of zlib's examples/zran.c.
+// build_trace_index() inflates a trace once and saves an access point at a deflate block boundary
+// every span bytes of inflated output: the compressed bit position, the 32KB of output preceding it
+// (the inflate dictionary needed to resume there), and the first trace instruction starting after it.
+// trace_seek_input then resumes inflating from the access point closest to a requested instruction,
+// so TraceReader can start at any instruction without inflating the trace from byte 0.
+//
+// Index file Format (<trace>.tidx) :
+// File header              - 64 bytes (trace_index_header_t)
+// Windows                  - 32KB each, one per access point
+// Access points            - 48 bytes each (trace_index_point_t)
+//
+// Usage : build_trace_index("./my_trace.gz", "./my_trace.gz.tidx");
+//         trace_index index;
+//         index.load("./my_trace.gz.tidx");
+//         trace_seek_input input("./my_trace.gz", index, 40000000);
+//         input.first_instr() is the instruction the input is positioned at (<= 40000000)
+//         input.read(&field, sizeof(field));
+//         if(input.eof()) ...
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+static constexpr char TRACE_INDEX_MAGIC[8] = {'C', 'B', 'P', 'T', 'I', 'D', 'X', '\0'};
+static constexpr uint32_t TRACE_INDEX_VERSION = 1;
+// Size of the inflate dictionary saved with each access point (maximum deflate distance).
+static constexpr size_t TRACE_INDEX_WINDOW_SIZE = 32768;
+// Default distance between access points, in bytes of inflated trace.
+static constexpr uint64_t TRACE_INDEX_DEFAULT_SPAN = 4 << 20;
+
+struct trace_index_header_t
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_points;
+    uint64_t span;
+    uint64_t num_instr;     // number of instructions in the trace
+    uint64_t reserved[4];
+};
+static_assert(sizeof(trace_index_header_t) == 64, "trace index header must be 64 bytes");
+
+struct trace_index_point_t
+{
+    uint64_t in;            // compressed offset of the first full byte after the access point
+    uint64_t out;           // inflated offset of the access point
+    uint64_t instr_num;     // first instruction starting at or after out
+    uint64_t instr_out;     // inflated offset of that instruction
+    uint8_t bits;           // number of bits (1-7) of the byte at in - 1 that belong to the access point, or 0
+    uint8_t pad[15];
+};
+static_assert(sizeof(trace_index_point_t) == 48, "trace index point must be 48 bytes");
+
+// Name of the sidecar index of a trace.
+inline std::string trace_index_name(const char * trace_name)
+{
+    return std::string(trace_name) + ".tidx";
+}
+
+// Inflates trace_name and writes its index to index_name. Returns false on error (message on stderr).
+bool build_trace_index(const char * trace_name, const char * index_name, uint64_t span = TRACE_INDEX_DEFAULT_SPAN);
+
+// Access points of an index file (windows are read on demand).
+class trace_index
+{
+public:
+    // Returns false if index_name is missing or is not a valid index.
+    bool load(const char * index_name);
+
+    uint64_t get_num_instr() const
+    {
+        return header.num_instr;
+    }
+
+    // Last access point whose first instruction is <= instr.
+    const trace_index_point_t& find(uint64_t instr) const;
+
+    // Reads the window of the access point returned by find().
+    bool read_window(const trace_index_point_t& point, uint8_t * window) const;
+
+private:
+    std::string name;
+    trace_index_header_t header;
+    std::vector<trace_index_point_t> points;
+};
+
+// Inflated trace bytes starting at the access point closest to a given instruction.
+// Same read()/eof() contract as trace_readahead.
+class trace_seek_input
+{
+public:
+    static constexpr size_t OUT_BUFFER_SIZE = 1 << 20;
+    static constexpr size_t IN_BUFFER_SIZE = 1 << 16;
+
+    trace_seek_input(const char * trace_name, const trace_index& index, uint64_t start_instr);
+    ~trace_seek_input();
+
+    trace_seek_input(const trace_seek_input&) = delete;
+    trace_seek_input& operator=(const trace_seek_input&) = delete;
+
+    bool is_open() const
+    {
+        return file != nullptr;
+    }
+
+    // Instruction the input is positioned at. The caller skips the instructions up to the one it wants.
+    uint64_t first_instr() const
+    {
+        return start_point_instr;
+    }
+
+    inline void read(void * dst, size_t n)
+    {
+        if(n <= (size_t)(cur_end - cur_ptr))
+        {
+            memcpy(dst, cur_ptr, n);
+            cur_ptr += n;
+            return;
+        }
+        read_slow(static_cast<char*>(dst), n);
+    }
+
+    bool eof() const
+    {
+        return at_eof;
+    }
+
+private:
+    FILE * file;
+    z_stream strm;
+    bool strm_init;
+    bool stream_end;
+    uint64_t start_point_instr;
+
+    std::unique_ptr<uint8_t[]> in_buffer;
+    std::unique_ptr<char[]> out_buffer;
+    const char * cur_ptr;
+    const char * cur_end;
+    bool at_eof;
+
+    bool refill();
+    void read_slow(char * dst, size_t n);
+};
@@ -0,0 +1,153 @@
+// CBP Trace Read-Ahead
+// See trace_readahead.h for a description.
+
+#include <algorithm>
+#include <cassert>
+#include "trace_readahead.h"
+
+trace_readahead::trace_readahead(const char * trace_name, size_t block_size, size_t num_blocks)
+    : file(nullptr)
+    , block_size(block_size)
+    , block_mask(num_blocks - 1)
+    , ring(num_blocks)
+    , head(0)
+    , tail(0)
+    , producer_done(false)
+    , stop_requested(false)
+    , cur_ptr(nullptr)
+    , cur_end(nullptr)
+    , holding_block(false)
+    , at_eof(false)
+{
+    assert(block_size > 0);
+    assert(num_blocks > 0 && (num_blocks & (num_blocks - 1)) == 0);
+
+    file = gzopen(trace_name, "rb");
+    if(file == nullptr)
+    {
+        producer_done.store(true, std::memory_order_release);
+        return;
+    }
+    // Let zlib pull compressed input from the file in large chunks as well.
+    gzbuffer(file, 1 << 20);
+
+    for(auto& blk : ring)
+    {
+        blk.data.reset(new char[block_size]);
+        blk.len = 0;
+    }
+
+    producer = std::thread(&trace_readahead::produce, this);
+}
+
+trace_readahead::~trace_readahead()
+{
+    stop_requested.store(true, std::memory_order_release);
+    if(producer.joinable())
+        producer.join();
+    if(file)
+        gzclose(file);
+}
+
+// Producer thread: inflate the trace into free ring slots until the trace ends or the consumer goes away.
+void trace_readahead::produce()
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+    bool trace_done = false;
+
+    while(!trace_done)
+    {
+        // Wait for the consumer to release a slot.
+        while((h - tail.load(std::memory_order_acquire)) == ring.size())
+        {
+            if(stop_requested.load(std::memory_order_acquire))
+            {
+                producer_done.store(true, std::memory_order_release);
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        block_t& blk = ring[h & block_mask];
+        size_t filled = 0;
+        while(filled < block_size)
+        {
+            const int num = gzread(file, blk.data.get() + filled, (unsigned)(block_size - filled));
+            if(num <= 0) // ERROR or EOF
+            {
+                trace_done = true;
+                break;
+            }
+            filled += num;
+        }
+
+        blk.len = filled;
+        if(filled != 0)
+        {
+            h++;
+            head.store(h, std::memory_order_release);
+        }
+
+        trace_done |= stop_requested.load(std::memory_order_acquire);
+    }
+
+    producer_done.store(true, std::memory_order_release);
+}
+
+// Releases the block being parsed (if any) and waits for the next one.
+// Returns false once the producer is done and every block has been consumed.
+bool trace_readahead::next_block()
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    if(holding_block)
+    {
+        t++;
+        tail.store(t, std::memory_order_release);
+        holding_block = false;
+    }
+
+    while(head.load(std::memory_order_acquire) == t)
+    {
+        if(producer_done.load(std::memory_order_acquire))
+        {
+            // The producer may have published a last block right before finishing.
+            if(head.load(std::memory_order_acquire) == t)
+            {
+                cur_ptr = cur_end = nullptr;
+                return false;
+            }
+            break;
+        }
+        std::this_thread::yield();
+    }
+
+    const block_t& blk = ring[t & block_mask];
+    cur_ptr = blk.data.get();
+    cur_end = cur_ptr + blk.len;
+    holding_block = true;
+    return true;
+}
+
+// Slow path of read(): the requested bytes straddle a block boundary (or no block is held yet).
+void trace_readahead::read_slow(char * dst, size_t n)
+{
+    while(n != 0)
+    {
+        const size_t avail = cur_end - cur_ptr;
+        if(avail == 0)
+        {
+            if(!next_block())
+            {
+                at_eof = true;
+                return;
+            }
+            continue;
+        }
+
+        const size_t chunk = std::min(avail, n);
+        memcpy(dst, cur_ptr, chunk);
+        cur_ptr += chunk;
+        dst += chunk;
+        n -= chunk;
+    }
+}
@@ -0,0 +1,92 @@
+// CBP Trace Read-Ahead
+//
+// Asynchronous decompression front-end for TraceReader.
+// A producer thread inflates the gz trace in large blocks into a single-producer/single-consumer
+// ring of buffers, and the simulation thread parses the trace by copying bytes out of the current block.
+// This hides zlib's inflate work behind the timing simulation instead of paying for it
+// a few hundred bytes at a time through gzstreambuf::underflow().
+//
+// Usage : trace_readahead input("./my_trace.gz");
+//         input.read(&field, sizeof(field));
+//         if(input.eof()) ...
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+class trace_readahead
+{
+public:
+    // Size of one inflated block handed from the producer to the consumer.
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 4 << 20;
+    // Number of blocks in the ring (must be a power of 2).
+    static constexpr size_t DEFAULT_NUM_BLOCKS = 4;
+
+    trace_readahead(const char * trace_name, size_t block_size = DEFAULT_BLOCK_SIZE, size_t num_blocks = DEFAULT_NUM_BLOCKS);
+    ~trace_readahead();
+
+    trace_readahead(const trace_readahead&) = delete;
+    trace_readahead& operator=(const trace_readahead&) = delete;
+
+    bool is_open() const
+    {
+        return file != nullptr;
+    }
+
+    // Copies n bytes of the trace into dst.
+    // If the trace ends before n bytes could be copied, eof() becomes true (same contract as std::istream::read).
+    inline void read(void * dst, size_t n)
+    {
+        if(n <= (size_t)(cur_end - cur_ptr))
+        {
+            memcpy(dst, cur_ptr, n);
+            cur_ptr += n;
+            return;
+        }
+        read_slow(static_cast<char*>(dst), n);
+    }
+
+    bool eof() const
+    {
+        return at_eof;
+    }
+
+private:
+    struct block_t
+    {
+        std::unique_ptr<char[]> data;
+        size_t len;
+    };
+
+    gzFile file;
+    size_t block_size;
+    size_t block_mask;
+    std::vector<block_t> ring;
+
+    // Number of blocks filled by the producer / released by the consumer.
+    // head - tail is the number of blocks ready to be consumed.
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    // Set by the producer once the last block has been published.
+    std::atomic<bool> producer_done;
+    // Set by the consumer to stop the producer early (e.g. -S limit reached).
+    std::atomic<bool> stop_requested;
+
+    // Consumer state, only touched by the simulation thread.
+    alignas(64) const char * cur_ptr;
+    const char * cur_end;
+    bool holding_block;
+    bool at_eof;
+
+    std::thread producer;
+
+    void produce();
+    bool next_block();
+    void read_slow(char * dst, size_t n);
+};
@@ -71,8 +71,14 @@
 #include <iostream>
 #include <vector>
 #include <cassert>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
 #include "sim_common_structs.h"
 #include "./gzstream.h"
+#include "trace_readahead.h"
+#include "cbpt_trace.h"
+#include "trace_index.h"
 
 // This structure is used by CBP's simulator.
 // Adapt for your own needs.
@@ -172,6 +178,52 @@ inline bool reg_is_int(uint8_t reg_offset)
 }
 
 
+// Bounded list with inline storage, used for the per-instruction register lists so that parsing a trace
+// instruction never touches the heap. N is the largest count the trace format is expected to produce.
+template<typename T, uint8_t N>
+struct inline_vec
+{
+    T mElts[N];
+    uint8_t mSize = 0;
+
+    uint8_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+    void clear() { mSize = 0; }
+
+    T * data() { return mElts; }
+    const T * data() const { return mElts; }
+    T * begin() { return mElts; }
+    T * end() { return mElts + mSize; }
+    const T * begin() const { return mElts; }
+    const T * end() const { return mElts + mSize; }
+
+    T& operator[](size_t i) { return mElts[i]; }
+    const T& operator[](size_t i) const { return mElts[i]; }
+    T& at(size_t i) { assert(i < mSize); return mElts[i]; }
+    const T& at(size_t i) const { assert(i < mSize); return mElts[i]; }
+    const T& back() const { assert(mSize > 0); return mElts[mSize - 1]; }
+
+    void push_back(const T& elt)
+    {
+        assert(mSize < N && "Register counts are checked by TraceReader::check_num_regs()");
+        mElts[mSize++] = elt;
+    }
+
+    void assign(const T * first, const T * last)
+    {
+        assert(last - first <= N && "Register counts are checked by TraceReader::check_num_regs()");
+        std::copy(first, last, mElts);
+        mSize = last - first;
+    }
+
+    void erase(T * pos)
+    {
+        assert(pos >= begin() && pos < end());
+        std::copy(pos + 1, end(), pos);
+        mSize--;
+    }
+};
+
 // Trace reader class.
 // Format assumes that instructions have at most three inputs and at most one input.
 // If the trace contains an instruction that has more than three inputs, they are ignored.
@@ -191,12 +243,19 @@ struct TraceReader
         uint8_t mMemSize; // In bytes
         uint8_t mBaseUpd;
         uint8_t mHasRegOffset;
+        // Largest register counts expected in a trace instruction (e.g. st4/ld4 with register offset and base update).
+        static constexpr uint8_t MAX_IN_REGS = 8;
+        static constexpr uint8_t MAX_OUT_REGS = 8;
+        static constexpr uint8_t MAX_OUT_VALUES = 2 * MAX_OUT_REGS;
+
         uint8_t mNumInRegs;
-        std::vector<uint8_t> mInRegs;
+        inline_vec<uint8_t, MAX_IN_REGS> mInRegs;
         uint8_t mNumOutRegs;
-        std::vector<uint8_t> mOutRegs;
+        inline_vec<uint8_t, MAX_OUT_REGS> mOutRegs;
         std::optional<uint8_t> mBaseUpdReg;
-        std::vector<uint64_t> mOutRegsValues;
+        inline_vec<uint64_t, MAX_OUT_VALUES> mOutRegsValues;
+        // Output values as laid out in the trace (2 per SIMD register, base update value included).
+        inline_vec<uint64_t, MAX_OUT_VALUES> mRawOutRegsValues;
 
         Instr()
         {
@@ -217,6 +276,7 @@ struct TraceReader
             mOutRegs.clear();
             mBaseUpdReg.reset();
             mOutRegsValues.clear();
+            mRawOutRegsValues.clear();
         }
 
         bool capture_base_update_log_reg()
@@ -267,46 +327,42 @@ struct TraceReader
             {
                 return false;
             }
-            auto src_reg_ids = mInRegs;
-            std::sort(src_reg_ids.begin(), src_reg_ids.end());
-            auto src_it = std::lower_bound(src_reg_ids.begin(), src_reg_ids.end(),  Offset::vecOffset);
-            if(src_it != src_reg_ids.end())
+            // The base register is the INT register that is both a source and a destination.
+            // Count the common INT registers (as a multiset intersection) by scanning the two short lists in place.
+            uint8_t num_overlap = 0;
+            uint8_t overlap_reg = UINT8_MAX;
+            for(uint8_t i = 0; i != mOutRegs.size(); i++)
             {
-                src_reg_ids.erase(src_it, src_reg_ids.end());
+                const uint8_t reg = mOutRegs[i];
+                if(reg >= Offset::vecOffset || std::find(mOutRegs.begin(), mOutRegs.begin() + i, reg) != mOutRegs.begin() + i)
+                {
+                    continue;
+                }
+                const uint8_t src_count = std::count(mInRegs.begin(), mInRegs.end(), reg);
+                if(src_count != 0)
+                {
+                    const uint8_t dst_count = std::count(mOutRegs.begin() + i, mOutRegs.end(), reg);
+                    num_overlap += std::min(src_count, dst_count);
+                    overlap_reg = reg;
+                }
             }
 
-            auto dst_reg_ids = mOutRegs;
-            std::sort(dst_reg_ids.begin(), dst_reg_ids.end());
-            auto dst_it = std::lower_bound(dst_reg_ids.begin(), dst_reg_ids.end(),  Offset::vecOffset);
-            if(dst_it != dst_reg_ids.end())
-            {
-                dst_reg_ids.erase(dst_it, dst_reg_ids.end());
-            }
-
-            std::vector<uint8_t> overlap_vec;
-            std::set_intersection(src_reg_ids.begin(), src_reg_ids.end(), dst_reg_ids.begin(), dst_reg_ids.end(), std::back_inserter(overlap_vec));
-
-            if(overlap_vec.size() > 1)
+            if(num_overlap > 1)
             {
                 std::cout<<"Load with >1 base upd! src_regs: [";
-                for(auto i:src_reg_ids)
+                for(auto i:mInRegs)
                 {
                     std::cout<<", "<<(uint64_t)i;
                 }
                 std::cout<<"], dst_regs: [";
-                for(auto i:dst_reg_ids)
-                {
-                    std::cout<<", "<<(uint64_t)i;
-                }
-                std::cout<<"], overlap_vec: [";
-                for(auto i:overlap_vec)
+                for(auto i:mOutRegs)
                 {
                     std::cout<<", "<<(uint64_t)i;
                 }
                 std::cout<<"]"<<std::endl;
             }
-            assert(overlap_vec.size() <= 1);
-            const bool base_update = overlap_vec.size() == 1;
+            assert(num_overlap <= 1);
+            const bool base_update = num_overlap == 1;
             if(mBaseUpd == 1)
             {
                 assert(base_update);
@@ -314,7 +370,7 @@ struct TraceReader
             const bool true_base_update = (mBaseUpd == 1) && base_update;
             if(true_base_update)
             {
-                mBaseUpdReg.emplace(overlap_vec.at(0));
+                mBaseUpdReg.emplace(overlap_reg);
             }
             return true_base_update;
         }
@@ -359,7 +415,12 @@ struct TraceReader
         }
     };
 
+    // Exactly one of these is used: the synchronous gzstream, the background read-ahead decompressor,
+    // a memory-mapped .cbpt trace, or a gz trace resumed from an access point of its index.
     gz::igzstream * dpressed_input;
+    trace_readahead * readahead_input;
+    cbpt_reader * cbpt_input;
+    trace_seek_input * seek_input;
 
     // Buffer to hold trace instruction information
     Instr mInstr;
@@ -387,6 +448,9 @@ struct TraceReader
     // Number of instructions processed so far.
     uint64_t nInstr;
 
+    // Progress and diagnostic messages of the reader, stdout unless given to the constructor.
+    std::ostream * msg_out;
+
     // This simply tracks how many lanes one SIMD register have been processed.
     // In this case, since SIMD is 128 bits and pieces output 64 bits, if it is pair and we are creating an instruction object from a trace instruction, this means that
     // the output of the instruction object will contain the low order bits of the SIMD register.
@@ -394,10 +458,42 @@ struct TraceReader
     uint8_t start_fp_reg;
 
     // Note that there is no check for trace existence, so modify to suit your needs.
-    TraceReader(const char * trace_name)
+    // Traces ending in .cbpt are memory-mapped (see cbpt_trace.h).
+    // Otherwise, if readahead is set, the gz trace is inflated by a background thread (see trace_readahead.h).
+    // If start_instr is set, the first start_instr trace instructions are skipped. For a gz trace with an index
+    // (see trace_index.h), inflating resumes from the closest access point instead of the beginning of the trace.
+    // Progress and diagnostic messages go to msg.
+    TraceReader(const char * trace_name, bool readahead = false, uint64_t start_instr = 0, std::ostream & msg = std::cout)
     {
-        dpressed_input = new gz::igzstream();
-        dpressed_input->open(trace_name, std::ios_base::in | std::ios_base::binary);
+        msg_out = &msg;
+        dpressed_input = nullptr;
+        readahead_input = nullptr;
+        cbpt_input = nullptr;
+        seek_input = nullptr;
+        uint64_t first_instr = 0;
+        if(is_cbpt_trace(trace_name))
+        {
+            cbpt_input = new cbpt_reader(trace_name);
+        }
+        else if(start_instr != 0 && open_seek_input(trace_name, start_instr))
+        {
+            first_instr = seek_input->first_instr();
+        }
+        else if(readahead)
+        {
+            readahead_input = new trace_readahead(trace_name);
+        }
+        else
+        {
+            dpressed_input = new gz::igzstream();
+            dpressed_input->open(trace_name, std::ios_base::in | std::ios_base::binary);
+        }
+
+        if(start_instr != 0)
+        {
+            *msg_out << "Skipping to trace instruction " << start_instr << " (from instruction " << first_instr << ")" << std::endl;
+            skipInstrs(start_instr - first_instr);
+        }
 
         mTotalPieces = 0;
         mMemPieces = 0;
@@ -413,45 +509,126 @@ struct TraceReader
     {
         if(dpressed_input)
             delete dpressed_input;
+        if(readahead_input)
+            delete readahead_input;
+        if(cbpt_input)
+            delete cbpt_input;
+        if(seek_input)
+            delete seek_input;
+
+        *msg_out << " Read " << nInstr << " instrs " << std::endl;
+    }
 
-        std::cout  << " Read " << nInstr << " instrs " << std::endl;
+    // Read n bytes from whichever input the trace is streamed from.
+    inline void read_trace(void * dst, size_t n)
+    {
+        if(readahead_input)
+            readahead_input->read(dst, n);
+        else if(seek_input)
+            seek_input->read(dst, n);
+        else
+            dpressed_input->read((char*) dst, n);
+    }
+
+    bool trace_eof() const
+    {
+        if(readahead_input)
+            return readahead_input->eof();
+        else if(seek_input)
+            return seek_input->eof();
+        return dpressed_input->eof();
+    }
+
+    // Opens the gz trace at the access point of its index closest to start_instr.
+    // Returns false if the trace has no (valid) index.
+    bool open_seek_input(const char * trace_name, uint64_t start_instr)
+    {
+        trace_index index;
+        if(!index.load(trace_index_name(trace_name).c_str()))
+        {
+            *msg_out << "No index for " << trace_name << ", inflating from the beginning of the trace" << std::endl;
+            return false;
+        }
+        seek_input = new trace_seek_input(trace_name, index, start_instr);
+        if(!seek_input->is_open())
+        {
+            delete seek_input;
+            seek_input = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // Skip the next num_instr trace instructions without cracking them into pieces.
+    void skipInstrs(uint64_t num_instr)
+    {
+        for(uint64_t i = 0; i != num_instr; i++)
+        {
+            mInstr.reset();
+            const bool instr_read = cbpt_input ? (cbpt_input->next() != nullptr) : decodeGzInstr();
+            if(!instr_read)
+            {
+                *msg_out << "Trace ended while skipping instructions" << std::endl;
+                break;
+            }
+        }
+        mInstr.reset();
     }
 
     // This is the main API function
     // There is no specific reason to call the other functions from without this file.
-    // Idiom is : while(instr = get_inst())
+    // Idiom is : db_t instr;
+    //            while(get_inst(instr))
     //              ... process instr
-    db_t  *get_inst()
+    // The caller owns the db_t, which is overwritten on every call, so no allocation is done per piece.
+    bool get_inst(db_t &inst)
     {
         // If we are creating several pieces from a single trace instructions and some are left to create,
         // mProcessedPieces != mTotalPieces
         if(mProcessedPieces != mTotalPieces)
         {
             //std::cout<<"Continuing with the same MacroOP"<<std::endl;
-            return populateNewInstr();
+            populateInstr(inst);
+            return true;
         }
         // If there is a single piece to create
         else if(readInstr())
         {
             //std::cout<<"Read New MacroOp"<<std::endl;
-            return populateNewInstr();
+            populateInstr(inst);
+            return true;
         }
         else
         {
             // If the trace is done
             //std::cout<<"End of sim"<<std::endl;
-            return nullptr;
+            return false;
         }
+    }
 
+    // Same as above, but returns a heap-allocated piece that the caller must delete (nullptr if the trace is done).
+    // Idiom is : while(instr = get_inst())
+    //              ... process instr
+    db_t  *get_inst()
+    {
+        db_t * inst = new db_t();
+        if(!get_inst(*inst))
+        {
+            delete inst;
+            return nullptr;
+        }
+        return inst;
     }
 
-    // Creates a new object and populate it with trace information.
-    // Subsequent calls to populateNewInstr() will take care of creating multiple pieces for a trace instruction
+    // Populates inst with trace information.
+    // Subsequent calls to populateInstr() will take care of creating multiple pieces for a trace instruction
     // that has several outputs or 128-bit output.
     // Number of calls is decided by mProcessedPieces from get_inst().
-    db_t *populateNewInstr()
+    void populateInstr(db_t &out)
     {
-        db_t * inst = new db_t();
+        // Start from a value-initialized piece, as if freshly allocated, so that no field leaks from the previous piece.
+        out = db_t();
+        db_t * inst = &out;
 
         //std::cout<<"Processing piece:"<<(uint64_t)(1+mProcessedPieces)<<" from:"<<(uint64_t)mTotalPieces<<std::endl;
         assert(mProcessedPieces < mTotalPieces);
@@ -608,12 +785,12 @@ struct TraceReader
         if(create_base_update_op)   // store output handled here
         {
             assert(base_update_reg_present);
-            assert(base_upd_reg == *mInstr.mOutRegs.rbegin());
+            assert(base_upd_reg == mInstr.mOutRegs.back());
             inst->D.valid = true;
             inst->D.is_int = reg_is_int(base_upd_reg);
             assert(inst->D.is_int);
             inst->D.log_reg = base_upd_reg;
-            inst->D.value = *mInstr.mOutRegsValues.rbegin();
+            inst->D.value = mInstr.mOutRegsValues.back();
         }
         else if(!is_store(mInstr.mType) && mInstr.mNumOutRegs >= 1)
         {
@@ -661,13 +838,23 @@ struct TraceReader
             mCrackValIdx++;
             mCrackRegIdx++;
         }
+    }
 
-        return inst;
+    // The register lists of Instr are stored inline: exit on a trace instruction with more registers than they hold,
+    // whether or not asserts are compiled in.
+    void check_num_regs(const char * what, uint64_t num, uint64_t max) const
+    {
+        if(num > max)
+        {
+            fprintf(stderr, "Trace instruction at PC 0x%" PRIx64 " (instruction %" PRIu64 ") has %" PRIu64 " %s, at most %" PRIu64 " are supported\n",
+                    mInstr.mPc, nInstr, num, what, max);
+            exit(1);
+        }
     }
 
-    // Read bytes from the trace and populate a buffer object.
-    // Returns true if something was read from the trace, false if we the trace is over.
-    bool readInstr()
+    // Read the raw fields of the next trace instruction from the gz trace into mInstr.
+    // Returns false if the trace is over.
+    bool decodeGzInstr()
     {
         // Trace Format :
         // Inst PC                  - 8 bytes
@@ -692,77 +879,151 @@ struct TraceReader
         //
         // Int registers are encoded 0-30(GPRs), 31(Stack Pointer Register), 64(Flag Register), 65(Zero Register)
         // SIMD registers are encoded 32-63
-        mInstr.reset();
-        start_fp_reg = 0;
-
-        dpressed_input->read((char*) &mInstr.mPc, sizeof(mInstr.mPc));
+        read_trace(&mInstr.mPc, sizeof(mInstr.mPc));
 
-        if(dpressed_input->eof())
+        if(trace_eof())
         {
-            std::cout<<"EOF"<<std::endl;
             return false;
         }
 
-        // reset bookkeeping variables
-        mTotalPieces = 0;
-        mMemPieces = 0;
-        mProcessedPieces = 0;
-        mSizeFactor = 1;
-        mCrackRegIdx = 0;
-        mCrackValIdx = 0;
-
         // default NextPc
         mInstr.mNextPc = mInstr.mPc + 4;
 
-        dpressed_input->read((char*) &mInstr.mType, sizeof(mInstr.mType));
+        read_trace(&mInstr.mType, sizeof(mInstr.mType));
 
         assert(mInstr.mType != InstClass::undefInstClass);
 
         //EffAddr is the base address
         if(mInstr.mType == InstClass::loadInstClass || mInstr.mType == InstClass::storeInstClass)
         {
-            dpressed_input->read((char*) &mInstr.mEffAddr, sizeof(mInstr.mEffAddr));
-            dpressed_input->read((char*) &mInstr.mMemSize, sizeof(mInstr.mMemSize));
-            dpressed_input->read((char*) &mInstr.mBaseUpd, sizeof(mInstr.mBaseUpd));
+            read_trace(&mInstr.mEffAddr, sizeof(mInstr.mEffAddr));
+            read_trace(&mInstr.mMemSize, sizeof(mInstr.mMemSize));
+            read_trace(&mInstr.mBaseUpd, sizeof(mInstr.mBaseUpd));
             if(mInstr.mType == InstClass::storeInstClass)
             {
-                dpressed_input->read((char*) &mInstr.mHasRegOffset, sizeof(mInstr.mHasRegOffset));
+                read_trace(&mInstr.mHasRegOffset, sizeof(mInstr.mHasRegOffset));
             }
         }
 
         if(is_br(mInstr.mType))
         {
-            dpressed_input->read((char*) &mInstr.mTaken, sizeof(mInstr.mTaken));
+            read_trace(&mInstr.mTaken, sizeof(mInstr.mTaken));
             if(!is_cond_br(mInstr.mType))
             {
                 assert(mInstr.mTaken);
             }
             if(mInstr.mTaken)
             {
-                dpressed_input->read((char*) &mInstr.mNextPc, sizeof(mInstr.mNextPc));
+                read_trace(&mInstr.mNextPc, sizeof(mInstr.mNextPc));
             }
         }
 
-        dpressed_input->read((char*) &mInstr.mNumInRegs, sizeof(mInstr.mNumInRegs));
+        read_trace(&mInstr.mNumInRegs, sizeof(mInstr.mNumInRegs));
+        check_num_regs("input registers", mInstr.mNumInRegs, Instr::MAX_IN_REGS);
 
         // capture logical src reg
         for(auto i = 0; i != mInstr.mNumInRegs; i++)
         {
             uint8_t inReg;
-            dpressed_input->read((char*) &inReg, sizeof(inReg));
+            read_trace(&inReg, sizeof(inReg));
             mInstr.mInRegs.push_back(inReg);
         }
 
-        dpressed_input->read((char*) &mInstr.mNumOutRegs, sizeof(mInstr.mNumOutRegs));
+        read_trace(&mInstr.mNumOutRegs, sizeof(mInstr.mNumOutRegs));
+        check_num_regs("output registers", mInstr.mNumOutRegs, Instr::MAX_OUT_REGS);
 
         // capture logical dst reg
         for(auto i = 0; i != mInstr.mNumOutRegs; i++)
         {
             uint8_t outReg;
-            dpressed_input->read((char*) &outReg, sizeof(outReg));
+            read_trace(&outReg, sizeof(outReg));
             mInstr.mOutRegs.push_back(outReg);
         }
 
+        // capture dst values, 16 bytes for SIMD registers
+        for(auto i = 0; i != mInstr.mNumOutRegs; i++)
+        {
+            const uint8_t num_vals = reg_is_int(mInstr.mOutRegs[i]) ? 1 : 2;
+            for(auto j = 0; j != num_vals; j++)
+            {
+                uint64_t val;
+                read_trace(&val, sizeof(val));
+                mInstr.mRawOutRegsValues.push_back(val);
+            }
+        }
+
+        return true;
+    }
+
+    // Same as decodeGzInstr(), for a .cbpt trace: all the fields are at fixed offsets in the mapped record.
+    bool decodeCbptInstr()
+    {
+        const cbpt_record_t * rec = cbpt_input->next();
+        if(rec == nullptr)
+        {
+            return false;
+        }
+
+        mInstr.mPc = rec->pc;
+        mInstr.mNextPc = mInstr.mPc + 4;
+        mInstr.mType = static_cast<InstClass>(rec->type);
+
+        assert(mInstr.mType != InstClass::undefInstClass);
+
+        if(is_mem(mInstr.mType))
+        {
+            mInstr.mEffAddr = rec->addr;
+            mInstr.mMemSize = rec->mem_size;
+            mInstr.mBaseUpd = (rec->flags & CBPT_BASE_UPD) != 0;
+            if(is_store(mInstr.mType))
+            {
+                mInstr.mHasRegOffset = (rec->flags & CBPT_REG_OFFSET) != 0;
+            }
+        }
+
+        if(is_br(mInstr.mType))
+        {
+            mInstr.mTaken = (rec->flags & CBPT_TAKEN) != 0;
+            if(mInstr.mTaken)
+            {
+                mInstr.mNextPc = rec->addr;
+            }
+        }
+
+        check_num_regs("input registers", rec->num_in_regs, Instr::MAX_IN_REGS);
+        check_num_regs("output registers", rec->num_out_regs, Instr::MAX_OUT_REGS);
+        check_num_regs("output values", rec->num_values, Instr::MAX_OUT_VALUES);
+        mInstr.mNumInRegs = rec->num_in_regs;
+        mInstr.mInRegs.assign(rec->in_regs(), rec->in_regs() + rec->num_in_regs);
+        mInstr.mNumOutRegs = rec->num_out_regs;
+        mInstr.mOutRegs.assign(rec->out_regs(), rec->out_regs() + rec->num_out_regs);
+        mInstr.mRawOutRegsValues.assign(rec->values(), rec->values() + rec->num_values);
+
+        return true;
+    }
+
+    // Read the next trace instruction and populate a buffer object.
+    // Returns true if something was read from the trace, false if we the trace is over.
+    bool readInstr()
+    {
+        mInstr.reset();
+        start_fp_reg = 0;
+
+        const bool instr_read = cbpt_input ? decodeCbptInstr() : decodeGzInstr();
+        if(!instr_read)
+        {
+            *msg_out<<"EOF"<<std::endl;
+            return false;
+        }
+
+        // reset bookkeeping variables
+        mTotalPieces = 0;
+        mMemPieces = 0;
+        mProcessedPieces = 0;
+        mSizeFactor = 1;
+        mCrackRegIdx = 0;
+        mCrackValIdx = 0;
+
         // assumes 1 piece per logical register output
         mTotalPieces =  (mInstr.mNumOutRegs > 0) ? mInstr.mNumOutRegs : 1;
 
@@ -771,11 +1032,10 @@ struct TraceReader
         uint8_t base_upd_pos_in_out_regs = UINT8_MAX;
         uint64_t base_upd_val = UINT64_MAX;
 
+        uint8_t raw_val_idx = 0;
         for(auto i = 0; i != mInstr.mNumOutRegs; i++)
         {
-            uint64_t val;
-
-            dpressed_input->read((char*) &val, sizeof(val));
+            uint64_t val = mInstr.mRawOutRegsValues.at(raw_val_idx++);
 
             const bool matching_base_upd = base_update_present && mInstr.mBaseUpdReg.value() == mInstr.mOutRegs[i];
             if(matching_base_upd) // capture base_upd_val and skip pushing it to OutRegVal
@@ -792,7 +1052,7 @@ struct TraceReader
                 if(!reg_is_int(mInstr.mOutRegs[i]))
                 {
                     assert(!is_store(mInstr.mType) && "Stores don't expect base updates for FP/SIMD/SVE regs");
-                    dpressed_input->read((char*) &val, sizeof(val));
+                    val = mInstr.mRawOutRegsValues.at(raw_val_idx++);
                     mInstr.mOutRegsValues.push_back(val);
                     if(val != 0)
                     {
@@ -801,6 +1061,7 @@ struct TraceReader
                 }
             }
         }
+        assert(raw_val_idx == mInstr.mRawOutRegsValues.size());
 
         const bool is_macro_op_mem = is_mem(mInstr.mType);
         // move dst/val to end of dst reg/vals 
@@ -825,13 +1086,13 @@ struct TraceReader
         if(is_store(mInstr.mType) ) // special handling of stores
         {
             // allow 1 addr reg, 1 offset reg and 1 value sources for store operations
-            // assumes first input register is the address register in populateNewInstr
+            // assumes first input register is the address register in populateInstr
             const uint8_t str_val_regs = mInstr.mNumInRegs - (1 + mInstr.mHasRegOffset); // accounting for store address reg + offset
             uint8_t true_str_val_regs = (str_val_regs  == 0) ? 1 : str_val_regs;
             if(mInstr.mMemSize%true_str_val_regs != 0)
             {
-                std::cout<<"Store! Size:"<<(uint64_t)mInstr.mMemSize<<" Expected value registers"<<(uint64_t)true_str_val_regs<<std::endl;
-                std::cout<<"str_val_regs:"<<(uint64_t)str_val_regs<<" InputRegCount:"<<(uint64_t)mInstr.mNumInRegs<<" REgOffset:"<<(uint64_t)mInstr.mHasRegOffset<<std::endl;
+                *msg_out<<"Store! Size:"<<(uint64_t)mInstr.mMemSize<<" Expected value registers"<<(uint64_t)true_str_val_regs<<std::endl;
+                *msg_out<<"str_val_regs:"<<(uint64_t)str_val_regs<<" InputRegCount:"<<(uint64_t)mInstr.mNumInRegs<<" REgOffset:"<<(uint64_t)mInstr.mHasRegOffset<<std::endl;
             }
             assert(mInstr.mMemSize%true_str_val_regs == 0); // all pieces should be of same size
             mMemPieces = true_str_val_regs;
@@ -871,7 +1132,7 @@ struct TraceReader
         nInstr++;
 
         if(nInstr % 5000000 == 0)
-            std::cout << nInstr << " instrs " << std::endl;
+            *msg_out << nInstr << " instrs " << std::endl;
 
         return true;
     }
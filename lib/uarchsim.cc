@@ -25,6 +25,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdlib.h>
 #include <inttypes.h>
 #include <sstream>
+#include <numeric>
 #include <assert.h>
 // #include "cbp.h"
 #include "value_predictor_interface.h"
@@ -38,8 +39,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "parameters.h"
 
 // uarchsim_t::uarchsim_t():window(WINDOW_SIZE),
-uarchsim_t::uarchsim_t()
-    : window_capacity(WINDOW_SIZE), L3(L3_SIZE, L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY, (cache_t *)NULL), L2(L2_SIZE, L2_ASSOC, L2_BLOCKSIZE, L2_LATENCY, &L3), L1(L1_SIZE, L1_ASSOC, L1_BLOCKSIZE, L1_LATENCY, &L2), BP(), IC(IC_SIZE, IC_ASSOC, IC_BLOCKSIZE, 0, &L2)
+uarchsim_t::uarchsim_t(CondDirPredictor *cond_pred)
+    : window(WINDOW_SIZE), window_capacity(WINDOW_SIZE), SQ(2 * WINDOW_SIZE), L3(L3_SIZE, L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY, (cache_t *)NULL), L2(L2_SIZE, L2_ASSOC, L2_BLOCKSIZE, L2_LATENCY, &L3), L1(L1_SIZE, L1_ASSOC, L1_BLOCKSIZE, L1_LATENCY, &L2), BP(cond_pred), cond_pred(cond_pred), IC(IC_SIZE, IC_ASSOC, IC_BLOCKSIZE, 0, &L2)
 {
    assert(WINDOW_SIZE != 0);
    // assert(FETCH_WIDTH);
@@ -78,12 +79,21 @@ uarchsim_t::uarchsim_t()
    // stats
    num_load = 0;
    num_load_sqmiss = 0;
+
+   if (LOG_LEVEL != 0)
+      activity_trace.open(ACTIVITY_TRACE_FILE, LOG_START_CYCLE, LOG_END_CYCLE);
 }
 
 uarchsim_t::~uarchsim_t()
 {
 }
 
+void uarchsim_t::begin()
+{
+   cond_pred->beginCondDirPredictor();
+   notify_subscription = cond_pred->get_notify_subscription();
+}
+
 void uarchsim_t::end_current_begin_new_epoch(const bool first_epoch, const bool last_epoch, const uint64_t epoch_end_cycle)
 {
    if (!first_epoch)
@@ -194,12 +204,11 @@ uint64_t uarchsim_t::get_load_exec_cycle(db_t *inst) const
    return exec_cycle;
 }
 
-void uarchsim_t::populate_exec_info(db_t *inst)
+void uarchsim_t::populate_exec_info(db_t *inst, ExecuteInfo &exec_info)
 {
-   _current_execute_info.reset();
+   exec_info.reset();
 
-   populate_decode_info(inst);
-   _current_execute_info.dec_info = _current_decode_info;
+   populate_decode_info(inst, exec_info.dec_info);
 
    if (is_br(inst->insn_class))
    {
@@ -208,63 +217,53 @@ void uarchsim_t::populate_exec_info(db_t *inst)
       {
          assert(branch_taken);
       }
-      _current_execute_info.taken.emplace(branch_taken);
-      //_current_execute_info.taken_target.emplace(inst->next_pc);
+      exec_info.taken.emplace(branch_taken);
+      //exec_info.taken_target.emplace(inst->next_pc);
    }
-   _current_execute_info.next_pc = inst->next_pc;
+   exec_info.next_pc = inst->next_pc;
 
    if (inst->is_load || inst->is_store)
    {
-      _current_execute_info.mem_va.emplace(inst->addr);
-      _current_execute_info.mem_sz.emplace(inst->size);
+      exec_info.mem_va.emplace(inst->addr);
+      exec_info.mem_sz.emplace(inst->size);
    }
 
    if (inst->D.valid)
    {
       assert(inst->D.log_reg < RFSIZE);
-      _current_execute_info.dst_reg_value.emplace(inst->D.value);
+      exec_info.dst_reg_value.emplace(inst->D.value);
    }
 }
 
-void uarchsim_t::populate_decode_info(db_t *inst)
+void uarchsim_t::populate_decode_info(db_t *inst, DecodeInfo &dec_info)
 {
-   _current_decode_info.reset();
-   _current_decode_info.insn_class = inst->insn_class;
+   dec_info.reset();
+   dec_info.insn_class = inst->insn_class;
 
    if (inst->A.valid)
    {
       assert(inst->A.log_reg < RFSIZE);
-      _current_decode_info.src_reg_info.push_back(inst->A.log_reg);
+      dec_info.src_reg_info.push_back(inst->A.log_reg);
    }
    if (inst->B.valid)
    {
       assert(inst->B.log_reg < RFSIZE);
-      _current_decode_info.src_reg_info.push_back(inst->B.log_reg);
+      dec_info.src_reg_info.push_back(inst->B.log_reg);
    }
    if (inst->C.valid)
    {
       assert(inst->C.log_reg < RFSIZE);
-      _current_decode_info.src_reg_info.push_back(inst->C.log_reg);
+      dec_info.src_reg_info.push_back(inst->C.log_reg);
    }
 
    // Anything to do if inst->D.log_reg != RFFLAGS
    if (inst->D.valid)
    {
       assert(inst->D.log_reg < RFSIZE);
-      _current_decode_info.dst_reg_info.emplace(inst->D.log_reg);
+      dec_info.dst_reg_info.emplace(inst->D.log_reg);
    }
 }
 
-const window_t &uarchsim_t::locate_entry_in_window(uint64_t seq_no, uint8_t piece) const
-{
-   const auto window_entry_it = std::lower_bound(window.begin(), window.end(), seq_no, [](const auto &window_entry, const uint64_t _my_seq)
-                                                 { return window_entry.seq_no < _my_seq; });
-   assert(window_entry_it != window.end());
-   assert(window_entry_it->seq_no == seq_no);
-   assert(window_entry_it->piece == piece);
-   return *window_entry_it;
-}
-
 #if 0
 void uarchsim_t::step(db_t *inst) 
 {
@@ -278,86 +277,79 @@ void uarchsim_t::step(db_t *inst)
 ////////////////////////
 // Manage DQ
 ////////////////////////
-void uarchsim_t::eval_decode(std::ostream &activity_trace, bool &activity_observed, const uint64_t current_cycle)
+void uarchsim_t::eval_decode(const uint64_t current_cycle)
 {
-   if (!DQ.empty())
+   DQ.drain(current_cycle, [&](uint64_t seq_no)
    {
-      bool process_dq = true;
-      while (process_dq)
-      {
-         auto dq_it = DQ.begin();
-         const auto [seq_no, piece, decode_cycle] = *dq_it;
-         assert(current_cycle <= decode_cycle);
-         if (current_cycle == decode_cycle)
-         {
-            const auto &window_entry = locate_entry_in_window(seq_no, piece);
-            assert(decode_cycle == window_entry.decode_cycle);
-            notify_instr_decode(window_entry.seq_no, window_entry.piece, window_entry.PC, window_entry.exec_info.dec_info, current_cycle);
-            DQ.pop_front();
-            process_dq = !DQ.empty();
-         }
-         else
-         {
-            process_dq = false;
-         }
-      }
-   }
+      const window_t &window_entry = window[seq_no];
+      assert(current_cycle == window_entry.decode_cycle);
+      cond_pred->notify_instr_decode(seq_no, window_entry.piece, window_entry.PC, window.exec_info(seq_no).dec_info, current_cycle);
+   });
 }
 
 ////////////////////////
 // Manage Execute
 ////////////////////////
-void uarchsim_t::eval_exec(std::ostream &activity_trace, bool &activity_observed, const uint64_t current_cycle)
+void uarchsim_t::eval_exec(const uint64_t current_cycle)
 {
-   auto eq_it = EQ.begin();
-   while (eq_it != EQ.end())
-   {
-      const auto [seq_no, piece, exec_cycle] = *eq_it;
-      assert(current_cycle <= exec_cycle);
-      if (current_cycle == exec_cycle)
-      {
-         const auto &window_entry = locate_entry_in_window(seq_no, piece);
-         assert(window_entry.exec_cycle == exec_cycle);
-         notify_instr_execute_resolve(window_entry.seq_no, window_entry.piece, window_entry.PC, window_entry.pred_taken, window_entry.exec_info, current_cycle);
-         activity_trace << current_cycle << "::Executed:" << window_entry << "\n";
-         activity_observed = true;
-         eq_it = EQ.erase(eq_it);
-      }
-      else
-      {
-         ++eq_it;
-      }
-   }
+   EQ.drain(current_cycle, [&](uint64_t seq_no)
+   {
+      const window_t &window_entry = window[seq_no];
+      const ExecuteInfo &exec_info = window.exec_info(seq_no);
+      assert(current_cycle == window_entry.exec_cycle);
+      if (inst_class_in(notify_subscription.execute, exec_info.dec_info.insn_class))
+         cond_pred->notify_instr_execute_resolve(seq_no, window_entry.piece, window_entry.PC, window_entry.pred_taken, exec_info, current_cycle);
+      activity_trace.record(activity_kind_t::Executed, current_cycle, window_entry, exec_info);
+   });
 }
 
 /////////////////////////////
 // Manage window: retire.
 /////////////////////////////
-void uarchsim_t::eval_retire(std::ostream &activity_trace, bool &activity_observed, const uint64_t current_cycle)
+void uarchsim_t::eval_retire(const uint64_t current_cycle)
 {
    while (!window.empty() && (current_cycle >= window.front().retire_cycle))
    {
       // window_t w = window.pop();
-      window_t w = window.front();
-      activity_trace << current_cycle << "::Retired:" << w << "\n";
-      activity_observed = true;
+      const window_t &w = window.front();
+      const ExecuteInfo &exec_info = window.exec_info(w.seq_no);
+      activity_trace.record(activity_kind_t::Retired, current_cycle, w, exec_info);
 
-      // window.pop();
-      window.pop_front();
-      notify_instr_commit(w.seq_no, w.piece, w.PC, w.pred_taken, w.exec_info, current_cycle);
+      if (inst_class_in(notify_subscription.commit, exec_info.dec_info.insn_class))
+         cond_pred->notify_instr_commit(w.seq_no, w.piece, w.PC, w.pred_taken, exec_info, current_cycle);
       if (VP_ENABLE && !VP_PERFECT)
          updatePredictor(w.seq_no, w.addr, w.value, w.latency);
+      // window.pop();
+      window.pop_front();
+   }
+}
+
+/////////////////////////////
+// Advance the pipe.
+/////////////////////////////
+void uarchsim_t::eval_cycles(const uint64_t first_cycle, const uint64_t last_cycle)
+{
+   // Evaluating a cycle without a decode, execute or retire event is a no-op: go from one event cycle to the next.
+   uint64_t current_cycle = first_cycle;
+   while (true)
+   {
+      const uint64_t retire_cycle = window.empty() ? UINT64_MAX : MAX(current_cycle, window.front().retire_cycle);
+      current_cycle = std::min({DQ.next_cycle(current_cycle, last_cycle), EQ.next_cycle(current_cycle, last_cycle), retire_cycle});
+      if (current_cycle > last_cycle)
+         break;
+      eval_decode(current_cycle);
+      eval_exec(current_cycle);
+      eval_retire(current_cycle);
+      current_cycle++;
    }
 }
 
 void uarchsim_t::step(db_t *inst)
 {
    spdlog::debug("Stepping, FC: {}", fetch_cycle);
-   bool activity_observed = false;
-   std::ostringstream activity_trace;
 
    // Preliminary step: determine which piece of the instruction this is.
-   static uint8_t piece = UINT8_MAX;
+   uint8_t &piece = fetch_piece;
    // static uint64_t prev_pc = 0xdeadbeef;
    piece = (piece == UINT8_MAX) ? 0 : (piece + 1);
    // prev_pc = inst->pc;
@@ -366,14 +358,7 @@ void uarchsim_t::step(db_t *inst)
    // advancing the pipe for the cycles skipped due to mispred/flush etc
    if (previous_fetch_cycle != fetch_cycle)
    {
-      uint64_t temp_fetch_cycle = previous_fetch_cycle;
-      while (temp_fetch_cycle <= fetch_cycle)
-      {
-         eval_decode(activity_trace, activity_observed, temp_fetch_cycle);
-         eval_exec(activity_trace, activity_observed, temp_fetch_cycle);
-         eval_retire(activity_trace, activity_observed, temp_fetch_cycle);
-         temp_fetch_cycle++;
-      }
+      eval_cycles(previous_fetch_cycle, fetch_cycle);
    }
 
    // CVP variables
@@ -384,8 +369,6 @@ void uarchsim_t::step(db_t *inst)
    //
    // Schedule the instruction's execution cycle.
    //
-   uint64_t i;
-   uint64_t addr;
 
    if (FETCH_MODEL_ICACHE)
    {
@@ -394,14 +377,7 @@ void uarchsim_t::step(db_t *inst)
       // advancing the pipe for the cycles skipped due to L1I$ miss
       if (next_fetch_cycle != fetch_cycle)
       {
-         uint64_t temp_fetch_cycle = fetch_cycle;
-         while (temp_fetch_cycle <= next_fetch_cycle)
-         {
-            eval_decode(activity_trace, activity_observed, temp_fetch_cycle);
-            eval_exec(activity_trace, activity_observed, temp_fetch_cycle);
-            eval_retire(activity_trace, activity_observed, temp_fetch_cycle);
-            temp_fetch_cycle++;
-         }
+         eval_cycles(fetch_cycle, next_fetch_cycle);
          fetch_cycle = next_fetch_cycle;
       }
    }
@@ -507,22 +483,12 @@ void uarchsim_t::step(db_t *inst)
       // Search of SQ takes 1 cycle after AGEN cycle.
       exec_cycle = (exec_cycle + 1);
 
-      bool inc_sqmiss = false;
-      uint64_t temp_cycle = 0;
-      for (i = 0, addr = inst->addr; i < inst->size; i++, addr++)
-      {
-         if ((SQ.find(addr) != SQ.end()) && (exec_cycle < SQ[addr].ret_cycle))
-         {
-            // SQ hit: the byte's timestamp is the later of load's execution cycle and store's execution cycle
-            temp_cycle = MAX(temp_cycle, MAX(exec_cycle, SQ[addr].exec_cycle));
-         }
-         else
-         {
-            // SQ miss: the byte's timestamp is its availability in L1 D$
-            temp_cycle = MAX(temp_cycle, data_cache_cycle);
-            inc_sqmiss = true;
-         }
-      }
+      // SQ hit: the byte's timestamp is the later of load's execution cycle and store's execution cycle
+      // SQ miss: the byte's timestamp is its availability in L1 D$
+      uint64_t temp_cycle;
+      const bool inc_sqmiss = !SQ.load(inst->addr, inst->size, exec_cycle, temp_cycle);
+      if (inc_sqmiss)
+         temp_cycle = MAX(temp_cycle, data_cache_cycle);
 
       num_load++;                              // stat
       num_load_sqmiss += (inc_sqmiss ? 1 : 0); // stat
@@ -547,8 +513,6 @@ void uarchsim_t::step(db_t *inst)
       exec_cycle += latency;
    }
 
-   activity_observed = true;
-
    // Drain prefetches from PF Queue
    // The idea is that a prefetch can go only if there is a free LDST slot "this" cycle
    // Here, "this" means all the cycles between the previous fetch cycle and the current one since all fetched ld/st will have been
@@ -562,25 +526,24 @@ void uarchsim_t::step(db_t *inst)
       {
          tmp_previous_fetch_cycle = MAX(previous_fetch_cycle, p.cycle_generated);
          issued = false;
-         while (tmp_previous_fetch_cycle <= fetch_cycle)
+         if (tmp_previous_fetch_cycle <= fetch_cycle)
          {
             spdlog::debug("Issuing prefetch:{}", p);
             uint64_t cycle_pf_exec = tmp_previous_fetch_cycle;
 
+            // First cycle with an empty LDST slot, up to the fetch cycle.
             if (ldst_lanes)
-               cycle_pf_exec = ldst_lanes->schedule(cycle_pf_exec, 0);
+               cycle_pf_exec = ldst_lanes->schedule(cycle_pf_exec, fetch_cycle - cycle_pf_exec);
 
             if (cycle_pf_exec != MAX_CYCLE)
             {
                L1.access(cycle_pf_exec, true, p.address, true);
                ++stat_pfs_issued_to_mem;
                issued = true;
-               break;
             }
             else
             {
-               tmp_previous_fetch_cycle++;
-               spdlog::debug("Could not find empty LDST slot for PF this cycle, increasing");
+               spdlog::debug("Could not find empty LDST slot for PF up to the fetch cycle");
             }
          }
 
@@ -607,7 +570,6 @@ void uarchsim_t::step(db_t *inst)
       {
          squash = (pred.speculate && (pred.predicted_value != inst->D.value));
          RF[inst->D.log_reg] = ((pred.speculate && (pred.predicted_value == inst->D.value)) ? fetch_cycle : exec_cycle);
-         activity_observed = true;
       }
    }
 
@@ -621,11 +583,7 @@ void uarchsim_t::step(db_t *inst)
          data_cache_cycle = L1.access(exec_cycle, true, inst->addr);
 
       uint64_t ret_cycle = MAX(data_cache_cycle, (window.empty() ? 0 : window.back().retire_cycle));
-      for (i = 0, addr = inst->addr; i < inst->size; i++, addr++)
-      {
-         SQ[addr].exec_cycle = exec_cycle;
-         SQ[addr].ret_cycle = ret_cycle;
-      }
+      SQ.store(inst->addr, inst->size, exec_cycle, ret_cycle, fetch_cycle);
    }
 
    // CVP measurements
@@ -641,28 +599,33 @@ void uarchsim_t::step(db_t *inst)
    //             ((inst->is_load || inst->is_store) ? inst->addr : 0xDEADBEEF),
    //             ((inst->D.valid && (inst->D.log_reg != RFFLAGS)) ? inst->D.value : 0xDEADBEEF),
    //       latency});
-   // window_t (uint64_t _seq_no, uint64_t _PC, uint64_t _fetch_cycle, uint64_t _decode_cycle, uint64_t _exec_cycle, ExecuteInfo _exec_info, uint64_t _retire_cycle, uint64_t _addr, uint64_t _value, uint64_t _latency)
    const uint64_t decode_cycle = fetch_cycle + DQ_LATENCY;
-   populate_exec_info(inst);
    assert(fetch_cycle < exec_cycle);
    const uint64_t predict_cycle = fetch_cycle;
-   window.push_back({seq_no,
-                     piece,
-                     inst->pc,
-                     fetch_cycle,
-                     decode_cycle,
-                     exec_cycle,
-                     _current_execute_info,
-                     MAX(exec_cycle, (window.empty() ? 0 : window.back().retire_cycle)),             // retire_cycle
-                     ((inst->is_load || inst->is_store) ? inst->addr : 0xDEADBEEF),                  // addr
-                     ((inst->D.valid && (inst->D.log_reg != RFFLAGS)) ? inst->D.value : 0xDEADBEEF), // value
-                     latency});                                                                      // latency
-   activity_trace << fetch_cycle << "::Fetched:" << window.back() << " Inst:" << *inst << "\n";
-   activity_observed = true;
+   const uint64_t retire_cycle = MAX(exec_cycle, (window.empty() ? 0 : window.back().retire_cycle));
+   window_t &window_entry = window.push_back(seq_no);
+   window_entry.piece = piece;
+   window_entry.PC = inst->pc;
+   window_entry.fetch_cycle = fetch_cycle;
+   window_entry.decode_cycle = decode_cycle;
+   window_entry.exec_cycle = exec_cycle;
+   window_entry.retire_cycle = retire_cycle;
+   window_entry.pred_taken = false;
+   window_entry.addr = ((inst->is_load || inst->is_store) ? inst->addr : 0xDEADBEEF);
+   window_entry.value = ((inst->D.valid && (inst->D.log_reg != RFFLAGS)) ? inst->D.value : 0xDEADBEEF);
+   window_entry.latency = latency;
+   ExecuteInfo &exec_info = window.exec_info(seq_no);
+   populate_exec_info(inst, exec_info);
+   activity_trace.record(activity_kind_t::Fetched, fetch_cycle, window_entry, exec_info, inst);
    assert(window.size() <= window_capacity);
 
-   DQ.push_back(std::make_tuple(seq_no, piece, decode_cycle));
-   EQ.push_back(std::make_tuple(seq_no, piece, exec_cycle));
+   // The DQ/EQ events refer to the window entry: it must not retire before them.
+   // Only the decode/execute events the predictor subscribed to are queued (and the execute events traced).
+   assert(decode_cycle <= retire_cycle);
+   if (inst_class_in(notify_subscription.decode, inst->insn_class))
+      DQ.schedule(decode_cycle, seq_no);
+   if (inst_class_in(notify_subscription.execute, inst->insn_class) || activity_trace.active(exec_cycle))
+      EQ.schedule(exec_cycle, seq_no);
 
    /////////////////////////////
    // Manage fetch cycle.
@@ -723,7 +686,7 @@ void uarchsim_t::step(db_t *inst)
          const bool taken_branch = (is_cond_br(inst->insn_class) && (inst->next_pc != (inst->pc + 4))) || is_uncond_br(inst->insn_class);
          if (!taken_branch)
          {
-            std::cout << activity_trace.str() << std::endl;
+            activity_trace.flush();
             std::cout << "FailingInstr" << *inst << std::endl;
          }
          assert(taken_branch);
@@ -758,19 +721,19 @@ void uarchsim_t::step(db_t *inst)
       bool predicted_taken = false;
       if (is_cond_br(inst->insn_class))
       {
-         predicted_taken = br_mispred ? !_current_execute_info.taken.value() : _current_execute_info.taken.value();
+         predicted_taken = br_mispred ? !exec_info.taken.value() : exec_info.taken.value();
       }
       else
       {
          predicted_taken = true;
-         if (!_current_execute_info.taken.value())
+         if (!exec_info.taken.value())
          {
             std::cout << "About to assert!" << std::endl;
             inst->printInst(fetch_cycle);
          }
-         assert(_current_execute_info.taken.value());
+         assert(exec_info.taken.value());
       }
-      window.back().update_pred_taken(predicted_taken);
+      window_entry.update_pred_taken(predicted_taken);
    }
 
    spdlog::debug("Updating base_cycle to {}", MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
@@ -781,11 +744,6 @@ void uarchsim_t::step(db_t *inst)
       ldst_lanes->advance_base_cycle(MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
    if (alu_lanes)
       alu_lanes->advance_base_cycle(MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
-   const bool dump_activity = LOG_LEVEL != 0 && (fetch_cycle >= LOG_START_CYCLE) && (fetch_cycle <= LOG_END_CYCLE);
-   if (dump_activity && activity_observed)
-   {
-      std::cout << activity_trace.str();
-   }
 
    if (inst->is_last_piece)
    {
@@ -814,6 +772,7 @@ uint64_t uarchsim_t::get_current_fetch_cycle() const
 void uarchsim_t::output()
 {
    end_current_begin_new_epoch(false /*first_epoch*/, true /*last_epoch*/, cycle);
+   activity_trace.close();
    // auto get_track_name = [] (uint64_t track){
    //    static std::string track_names [] = {
    //       "ALL",
@@ -864,6 +823,7 @@ void uarchsim_t::output()
    printf("L3$: %lu %s, %lu-way set-assoc., %luB block size, %lu-cycle search latency\n",
           SCALED_SIZE(L3_SIZE), SCALED_UNIT(L3_SIZE), L3_ASSOC, L3_BLOCKSIZE, L3_LATENCY);
    printf("Main Memory: %lu-cycle fixed search time\n", MAIN_MEMORY_LATENCY);
+   printf("Cache replacement: %s\n", ((CACHE_REPLACEMENT == CACHE_TREE_PLRU) ? "tree pseudo-LRU" : "LRU"));
    printf("---------------------------STORE QUEUE MEASUREMENTS (Full Simulation i.e. Counts Not Reset When Warmup Ends)---------------------------\n");
    printf("Number of loads: %lu\n", num_load);
    printf("Number of loads that miss in SQ: %lu (%.2f%%)\n", num_load_sqmiss, 100.0 * (double)num_load_sqmiss / (double)num_load);
@@ -896,3 +856,18 @@ void uarchsim_t::output()
    BP.output();
    BP.output_periodic_info(num_insts_per_epoch, num_cycles_per_epoch);
 }
+
+uarchsim_t::results_t uarchsim_t::results()
+{
+   end_current_begin_new_epoch(false /*first_epoch*/, true /*last_epoch*/, cycle);
+   activity_trace.close();
+
+   results_t res;
+   res.num_inst = num_inst;
+   res.cycles = cycle;
+   res.cycles_on_wrong_path = cycles_on_wrong_path;
+   const uint64_t total_instr = std::accumulate(num_insts_per_epoch.begin(), num_insts_per_epoch.end(), (uint64_t)0);
+   res.conddir_full = BP.measure_conddir(num_insts_per_epoch, num_cycles_per_epoch, total_instr);
+   res.conddir_half = BP.measure_conddir(num_insts_per_epoch, num_cycles_per_epoch, total_instr / 2);
+   return res;
+}
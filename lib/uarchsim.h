@@ -29,6 +29,10 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //#include "cbp.h"
 #include "value_predictor_interface.h"
 #include "stride_prefetcher.h"
+#include "event_wheel.h"
+#include "store_queue.h"
+#include "instr_window.h"
+#include "activity_trace.h"
 using namespace std;
 
 #ifndef _RISCV_UARCHSIM_H
@@ -38,76 +42,6 @@ using namespace std;
 #define RFFLAGS 64  // flags register is r64 (65th register)
 #define RFZERO 65   // zero register is r65 (66th register)
 
-struct window_t {
-   uint64_t seq_no;
-   uint8_t piece;
-   uint64_t PC;
-   uint64_t fetch_cycle;
-   uint64_t decode_cycle;
-   uint64_t exec_cycle;
-   ExecuteInfo exec_info;
-   uint64_t retire_cycle;
-   bool pred_taken;
-   uint64_t addr;
-   uint64_t value;
-   uint64_t latency;
-   window_t (uint64_t _seq_no, uint8_t _piece, uint64_t _PC, uint64_t _fetch_cycle, uint64_t _decode_cycle, uint64_t _exec_cycle, ExecuteInfo _exec_info, uint64_t _retire_cycle, uint64_t _addr, uint64_t _value, uint64_t _latency)
-     : seq_no(_seq_no)
-     , piece(_piece)
-     , PC(_PC)
-     , fetch_cycle(_fetch_cycle)
-     , decode_cycle(_decode_cycle)
-     , exec_cycle(_exec_cycle)
-     , exec_info(_exec_info)
-     , retire_cycle(_retire_cycle)
-     , pred_taken(false)
-     , addr(_addr)
-     , value(_value)
-     , latency(_latency)
-   {}
-
-   window_t()
-     : seq_no(UINT64_MAX)
-     , piece(UINT8_MAX)
-     , PC(UINT64_MAX)
-     , fetch_cycle(UINT64_MAX)
-     , decode_cycle(UINT64_MAX)
-     , exec_cycle(UINT64_MAX)
-     , retire_cycle(UINT64_MAX)
-     , pred_taken(false)
-     , addr(UINT64_MAX)
-     , value(UINT64_MAX)
-     , latency(UINT64_MAX)
-   {
-   }
-
-   void update_pred_taken(bool _pred_taken)
-   {
-      pred_taken = _pred_taken;
-   }
-
-   friend std::ostream& operator<<(std::ostream& os, const window_t& entry)
-   {
-       os<<"{";
-       os<<" ["<<entry.seq_no<<","<<(uint64_t)entry.piece<<"]";
-       os<<" PC:0x"<<std::hex<<entry.PC<<std::dec;
-       os<<" Class:"<<cInfo[static_cast<uint8_t>(entry.exec_info.dec_info.insn_class)];
-       os<<" TakenPopulated:"<<entry.exec_info.taken.has_value();
-       os<<" TakenVal:"<<entry.exec_info.taken.value_or(false);
-       os<<" fetch_cycle:"<<entry.fetch_cycle;
-       os<<" decode_cycle:"<<entry.decode_cycle;
-       os<<" exec_cycle:"<<entry.exec_cycle;
-       os<<" retire_cycle:"<<entry.retire_cycle;
-       os<<"}";
-       return os;
-   }
-};
-
-struct store_queue_t {
-   uint64_t exec_cycle; // store's execution cycle
-   uint64_t ret_cycle;  // store's commit cycle
-};
-
 // Class for a microarchitectural simulator.
 
 class uarchsim_t {
@@ -118,7 +52,7 @@ class uarchsim_t {
       uint64_t num_fetched;
       uint64_t num_fetched_branch;
       //fifo_t<window_t> window;
-      std::deque<window_t> window;
+      instr_window_t window;
       uint64_t window_capacity;
       resource_schedule *alu_lanes;
       resource_schedule *ldst_lanes;
@@ -127,10 +61,12 @@ class uarchsim_t {
       uint64_t RF[RFSIZE];
 
       // store queue byte timestamps
-      unordered_map<uint64_t, store_queue_t> SQ;
+      store_queue_t SQ;
 
-      std::deque<std::tuple<uint64_t/*seq_no*/, uint8_t/*piece*/, uint64_t/*decode_cycle*/>> DQ;
-      std::list<std::tuple<uint64_t/*seq_no*/, uint8_t/*piece*/, uint64_t/*exec_cycle*/>> EQ;
+      // decode/execute notifications, keyed by decode_cycle/exec_cycle. Events are the seq_no of their window entry:
+      // it stays in the window until its retire_cycle, which is not before its decode_cycle and exec_cycle.
+      event_wheel_t<uint64_t> DQ;
+      event_wheel_t<uint64_t> EQ;
 
       // memory block timestamps
       cache_t L3;
@@ -143,6 +79,10 @@ class uarchsim_t {
    
       // Branch predictor.
       bp_t BP;
+      // Conditional branch direction predictor driven by BP, also notified of decode/execute/commit (not owned).
+      CondDirPredictor *cond_pred;
+      // Instruction classes cond_pred is notified of decode/execute/commit for (read by begin()).
+      NotifySubscription notify_subscription;
 
       // Instruction cache.
       cache_t IC;
@@ -171,26 +111,46 @@ class uarchsim_t {
 
       uint64_t stat_pfs_issued_to_mem = 0;
 
+      // Fetch/execute/retire events, recorded when LOG_LEVEL != 0 (see activity_trace.h).
+      activity_trace_t activity_trace;
+
+      // Piece of the instruction being fetched (UINT8_MAX between instructions).
+      uint8_t fetch_piece = UINT8_MAX;
+
       // Helper for oracle hit/miss information
       uint64_t get_load_exec_cycle(db_t *inst) const;
 
-      DecodeInfo _current_decode_info;
-      ExecuteInfo _current_execute_info;
-      void populate_exec_info(db_t *inst); 
-      void populate_decode_info(db_t *inst); 
-      const window_t& locate_entry_in_window(uint64_t seq_no, uint8_t piece) const;
+      void populate_exec_info(db_t *inst, ExecuteInfo &exec_info);
+      void populate_decode_info(db_t *inst, DecodeInfo &dec_info);
       void end_current_begin_new_epoch(const bool first_epoch, const bool last_epoch, const uint64_t epoch_end_cycle);
 
    public:
-      uarchsim_t();
+      uarchsim_t(CondDirPredictor *cond_pred);
       ~uarchsim_t();
 
+      // Calls beginCondDirPredictor() of the predictor: call it once, before the first step().
+      void begin();
+
       //void set_funcsim(processor_t *funcsim);
       void step(db_t *inst);
-      void eval_decode(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_fetch_cycle) ;
-      void eval_exec(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_fetch_cycle) ;
-      void eval_retire(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_fetch_cycle) ;
+      void eval_decode(const uint64_t current_fetch_cycle) ;
+      void eval_exec(const uint64_t current_fetch_cycle) ;
+      void eval_retire(const uint64_t current_fetch_cycle) ;
+      // eval_decode/eval_exec/eval_retire for cycles first_cycle to last_cycle, skipping the cycles without events.
+      void eval_cycles(const uint64_t first_cycle, const uint64_t last_cycle) ;
       void output();
+
+      // Headline measurements, for tables of results (cbp-batch). Like output(), closes the last epoch:
+      // call one of them, once, at the end of the simulation.
+      struct results_t
+      {
+         uint64_t num_inst;
+         uint64_t cycles;
+         uint64_t cycles_on_wrong_path;
+         bp_t::conddir_meas_t conddir_full;   // Full simulation
+         bp_t::conddir_meas_t conddir_half;   // Last 50 Perc instructions
+      };
+      results_t results();
       uint64_t get_current_fetch_cycle() const;
       PredictionRequest get_value_prediction_req_for_track(uint64_t cycle, uint64_t seq_no, uint8_t piece, db_t *inst);
 };
@@ -1,10 +1,9 @@
 #include "my_pred.h"
 #include <cassert>
-#include <sstream>
 #include <stdio.h>
-
-// global variable
-MyPred my_pred;
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 uint32_t MyPred::get_PAg_pht_index(uint64_t key)
 {
@@ -23,6 +22,76 @@ int8_t sat_update(int8_t weight, int delta) {
     if (val < -128) return -128;
     return (int8_t)val;
 }
+
+// Perceptron kernels, over a row of PERCEPTRON_ROW weights.
+// The input of weight j is x_j = +1 if bit j of bits is set and -1 otherwise, for the weights set in active
+// (the others are padding, with input 0).
+//
+// With AVX2 (e.g. make OPT="-O3 -mavx2"), the bits are expanded to a byte mask and the whole row is summed or
+// trained at once, with saturating int8 adds for training. Otherwise a scalar loop does the same, to the same result.
+#if defined(__AVX2__)
+// 0xFF in byte j if bit j of bits is set, 0 otherwise.
+static inline __m256i expand_bits(uint32_t bits)
+{
+    const __m256i shuffle = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                             2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bit = _mm256_set1_epi64x(0x8040201008040201);
+    const __m256i bytes = _mm256_shuffle_epi8(_mm256_set1_epi32(bits), shuffle);
+    return _mm256_cmpeq_epi8(_mm256_and_si256(bytes, bit), bit);
+}
+
+// sum_j w_j * x_j
+static inline int perceptron_dot(const int8_t *w, uint32_t bits, uint32_t active)
+{
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i weights = _mm256_load_si256((const __m256i *)w);
+    const __m256i plus = _mm256_and_si256(expand_bits(bits & active), ones);
+    const __m256i minus = _mm256_and_si256(expand_bits(~bits & active), ones);
+    // Pairs of weights times 0/1, summed on 16 bits, then on 32 bits.
+    const __m256i sum16 = _mm256_sub_epi16(_mm256_maddubs_epi16(plus, weights), _mm256_maddubs_epi16(minus, weights));
+    __m256i sum32 = _mm256_madd_epi16(sum16, _mm256_set1_epi16(1));
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sum32), _mm256_extracti128_si256(sum32, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+// w_j = sat(w_j + t * x_j), t = +1/-1
+static inline void perceptron_train(int8_t *w, uint32_t bits, uint32_t active, int t)
+{
+    const __m256i delta = _mm256_and_si256(_mm256_blendv_epi8(_mm256_set1_epi8(-t), _mm256_set1_epi8(t), expand_bits(bits)),
+                                           expand_bits(active));
+    _mm256_store_si256((__m256i *)w, _mm256_adds_epi8(_mm256_load_si256((const __m256i *)w), delta));
+}
+#else
+// sum_j w_j * x_j
+static inline int perceptron_dot(const int8_t *w, uint32_t bits, uint32_t active)
+{
+    int y = 0;
+    for (int j = 0; j < PERCEPTRON_ROW; j++) {
+        int32_t x = ((active >> j) & 1) ? (((bits >> j) & 1) ? 1 : -1) : 0;
+        y += w[j] * x;
+    }
+    return y;
+}
+
+// w_j = sat(w_j + t * x_j), t = +1/-1
+static inline void perceptron_train(int8_t *w, uint32_t bits, uint32_t active, int t)
+{
+    for (int j = 0; j < PERCEPTRON_ROW; j++) {
+        int32_t x = ((active >> j) & 1) ? (((bits >> j) & 1) ? 1 : -1) : 0;
+        int val = w[j] + x * t;
+        w[j] = (int8_t)((val > 127) ? 127 : ((val < -128) ? -128 : val));
+    }
+}
+#endif
+
+// Inputs of the perceptron rows: the global row starts with the bias, whose input is always +1.
+static inline uint32_t global_row_bits(uint64_t ghr) { return (uint32_t)(((ghr & GHR_MASK) << 1) | 1); }
+static const uint32_t GLOBAL_ROW_ACTIVE = (1u << (GHR_LEN + 1)) - 1;
+static const uint32_t LOCAL_ROW_ACTIVE = (1u << HR_LEN) - 1;
+static const uint32_t PATH_ROW_ACTIVE = (1u << PHR_LEN) - 1;
+
 uint32_t fold_pc_12bit(uint64_t pc) {
     uint32_t result = 0;
     result ^= (pc >> 0)  & 0xFFF;  // Bits 0-11
@@ -72,13 +141,9 @@ void MyPred::init()
     ghr = 0;
     // Initialize perceptron weights
     for (int i = 0; i < (1 << Address_Bits); i++) {
-        for (int j = 0; j <= GHR_LEN; j++) {
+        for (int j = 0; j < PERCEPTRON_ROW; j++) {
             global_perceptron[i][j] = 0;
-        }
-        for (int j = 0; j < HR_LEN; j++) {
             local_perceptron[i][j] = 0;
-        }
-        for (int j = 0; j < PHR_LEN; j++) {
             path_perceptron[i][j] = 0;
         }
     }
@@ -106,13 +171,13 @@ bool MyPred::predict(uint64_t seq_no, uint8_t piece, uint64_t pc) {
     // Global Index: PC XORed with most recent GHR bits
     uint32_t g_idx = pc_8 ^ (ghr & 0xFF);
     
-    // Local Index: PC XORed with the local history bits
+    // Local Index: PC XORed with the local history bits (folded into the table)
     uint32_t pa_ht_index = fold_pc_10bit(pc); 
     uint32_t local_history = pa_ht[pa_ht_index] & HR_MASK;
-    uint32_t l_idx = fold_pc_8bit(pc) ^ local_history;
+    uint32_t l_idx = (fold_pc_8bit(pc) ^ local_history) & ((1 << Address_Bits) - 1);
     
-    // Path Index: PC XORed with the path history (Target addresses)
-    uint32_t p_idx = fold_pc_8bit(pc) ^ (phr & 0x3FF);
+    // Path Index: PC XORed with the path history (Target addresses), folded into the table
+    uint32_t p_idx = (fold_pc_8bit(pc) ^ (phr & 0x3FF)) & ((1 << Address_Bits) - 1);
     
     // Sub-expert Indices
     uint32_t PAg_index = get_PAg_pht_index(local_history);
@@ -123,20 +188,9 @@ bool MyPred::predict(uint64_t seq_no, uint8_t piece, uint64_t pc) {
     int8_t *l_w = local_perceptron[l_idx];
     int8_t *p_w = path_perceptron[p_idx];
     
-    int y = g_w[0]; // Global Bias
-    
-    for (int i = 0; i < GHR_LEN; i++) {
-        int32_t mask = ((ghr >> i) & 1) - 1;
-        y += (g_w[i + 1] ^ mask) - mask;
-    }
-    for (int i = 0; i < HR_LEN; i++) {
-        int32_t mask = ((local_history >> i) & 1) - 1;
-        y += (l_w[i] ^ mask) - mask;
-    }
-    for (int i = 0; i < PHR_LEN; i++) {
-        int32_t mask = ((phr >> i) & 1) - 1;
-        y += (p_w[i] ^ mask) - mask;
-    }
+    int y = perceptron_dot(g_w, global_row_bits(ghr), GLOBAL_ROW_ACTIVE);   // Global Bias + global history
+    y += perceptron_dot(l_w, local_history, LOCAL_ROW_ACTIVE);
+    y += perceptron_dot(p_w, (uint32_t)phr, PATH_ROW_ACTIVE);
 
     // Sub-expert Votes
     bool pag_pred = (PAg_pht[PAg_index] >= 2);
@@ -159,7 +213,7 @@ bool MyPred::predict(uint64_t seq_no, uint8_t piece, uint64_t pc) {
     meta.pag_pred = pag_pred;
     meta.gag_pred = gag_pred;
     meta.ex_ghr_idx = GAg_index;
-    br_hist[seq_no] = meta;
+    br_hist.insert(seq_no) = meta;
 
     return (y >= 0);
 }
@@ -186,9 +240,9 @@ void MyPred::spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool
 
 void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_dir, bool pred_dir, uint64_t next_pc) 
 {
-    auto it = br_hist.find(seq_no);
-    if(it == br_hist.end()) return;
-    BranchMetadata meta = it->second;
+    const BranchMetadata *found = br_hist.find(seq_no);
+    if(found == NULL) return;
+    const BranchMetadata &meta = *found;
 
     bool mispredicted = (pred_dir != resolve_dir);
     int t = resolve_dir ? 1 : -1;
@@ -198,19 +252,9 @@ void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_di
         int8_t *l_w = local_perceptron[meta.l_idx];
         int8_t *p_w = path_perceptron[meta.p_idx];
 
-        g_w[0] = sat_update(g_w[0], t);
-        for (int i = 0; i < GHR_LEN; i++) {
-            int x_i = ((meta.ghr_bits >> i) & 1) ? 1 : -1;
-            g_w[i+1] = sat_update(g_w[i+1], x_i * t);
-        }
-        for (int i = 0; i < HR_LEN; i++) {
-            int x_i = ((meta.lhist_bits >> i) & 1) ? 1 : -1;
-            l_w[i] = sat_update(l_w[i], x_i * t);
-        }
-        for (int i = 0; i < PHR_LEN; i++) {
-            int x_i = ((meta.phr_bits >> i) & 1) ? 1 : -1;
-            p_w[i] = sat_update(p_w[i], x_i * t);
-        }
+        perceptron_train(g_w, global_row_bits(meta.ghr_bits), GLOBAL_ROW_ACTIVE, t);
+        perceptron_train(l_w, meta.lhist_bits, LOCAL_ROW_ACTIVE, t);
+        perceptron_train(p_w, meta.phr_bits, PATH_ROW_ACTIVE, t);
 
         w_pag = sat_update(w_pag, (meta.pag_pred ? 1 : -1) * t);
         if(ghr_threshold) w_gag = sat_update(w_gag, (meta.gag_pred ? 1 : -1) * t);
@@ -249,6 +293,5 @@ void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_di
 
 void MyPred::commit(uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
-    // std::string br_id = get_br_id(seq_no, piece, pc);
     br_hist.erase(seq_no);
 }
\ No newline at end of file
@@ -3,10 +3,10 @@
 
 #include <cstdint>
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include <climits>
 #include <cstdlib>
+#include "lib/inflight_table.h"
 
 #define HR_LEN 10
 #define paBHT_LEN 1024  // pre-address Branch Hitory Tablen 
@@ -25,6 +25,11 @@
 #define PHR_LEN 16      //Path History Register
 #define PHR_MASK ((1ul << PHR_LEN) - 1)
 
+// Every perceptron row is padded to 32 weights and aligned on 32 bytes, so that it is summed and trained
+// as one vector (see perceptron_dot/perceptron_train in my_pred.cc). The padding weights stay 0.
+#define PERCEPTRON_ROW 32
+static_assert((GHR_LEN + 1 <= PERCEPTRON_ROW) && (HR_LEN <= PERCEPTRON_ROW) && (PHR_LEN <= PERCEPTRON_ROW), "Perceptron rows do not fit");
+
 struct BranchMetadata {
     uint32_t g_idx;       // Index for global_perceptron
     uint32_t l_idx;       // Index for local_perceptron
@@ -50,12 +55,12 @@ private:
     const int TC_MAX = 31;   // When to increment theta
     const int TC_MIN = -32;  // When to decrement theta
 
-    int8_t global_perceptron[(1 << Address_Bits)][GHR_LEN + 1];   // +1 is for bias and global weight
+    alignas(32) int8_t global_perceptron[(1 << Address_Bits)][PERCEPTRON_ROW];   // GHR_LEN + 1: +1 is for bias and global weight
     int8_t w_pecp;
 
-    int8_t local_perceptron[(1 << Address_Bits)][HR_LEN];
+    alignas(32) int8_t local_perceptron[(1 << Address_Bits)][PERCEPTRON_ROW];   // HR_LEN
 
-    int8_t path_perceptron[(1 << Address_Bits)][PHR_LEN];
+    alignas(32) int8_t path_perceptron[(1 << Address_Bits)][PERCEPTRON_ROW];    // PHR_LEN
 
     uint64_t pa_ht[paBHT_LEN];
     uint8_t PAg_pht[PAg_PHT_SIZE];
@@ -76,9 +81,8 @@ private:
     // Technically, this information could have been stored
     // along with the instruction itself. But since we don't
     // have access to such APIs, we are storing it by ourselves.
-    std::unordered_map<uint64_t, BranchMetadata> br_hist;
+    inflight_table_t<BranchMetadata> br_hist;
 
-    std::string get_br_id(uint64_t, uint8_t, uint64_t);
     uint32_t get_PAg_pht_index(uint64_t);
     uint32_t get_GAg_pht_index(uint64_t);
     uint32_t get_pa_ht_index(uint64_t, uint8_t, uint64_t);
@@ -98,6 +102,3 @@ public:
 };
 
 #endif
-
-// global variable
-extern MyPred my_pred;
@@ -1,11 +1,7 @@
 #include "my_pred.h"
 #include <cassert>
-#include <sstream>
 #include <stdio.h>
 
-// global variable
-MyPred my_pred;
-
 uint32_t MyPred::get_PAg_pht_index(uint64_t key)
 {
     return key % PAg_PHT_SIZE;
@@ -159,7 +155,7 @@ bool MyPred::predict(uint64_t seq_no, uint8_t piece, uint64_t pc) {
     meta.pag_pred = pag_pred;
     meta.gag_pred = gag_pred;
     meta.ex_ghr_idx = GAg_index;
-    br_hist[seq_no] = meta;
+    br_hist.insert(seq_no) = meta;
 
     return (y >= 0);
 }
@@ -186,9 +182,9 @@ void MyPred::spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool
 
 void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_dir, bool pred_dir, uint64_t next_pc) 
 {
-    auto it = br_hist.find(seq_no);
-    if(it == br_hist.end()) return;
-    BranchMetadata meta = it->second;
+    const BranchMetadata *found = br_hist.find(seq_no);
+    if(found == NULL) return;
+    BranchMetadata meta = *found;
 
     bool mispredicted = (pred_dir != resolve_dir);
     int t = resolve_dir ? 1 : -1;
@@ -249,6 +245,5 @@ void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_di
 
 void MyPred::commit(uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
-    // std::string br_id = get_br_id(seq_no, piece, pc);
     br_hist.erase(seq_no);
 }
\ No newline at end of file
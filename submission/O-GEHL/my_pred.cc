@@ -1,8 +1,5 @@
 #include "my_pred.h"
 
-// global variable
-MyPred my_pred;
-
 
 // Helper for saturation logic
 int8_t sat_update(int8_t weight, int delta) {
@@ -84,7 +81,7 @@ bool MyPred::predict(uint64_t seq_no, uint8_t piece, uint64_t pc) {
     }
 
     meta.y_at_predict = y;
-    br_hist[seq_no] = meta;
+    br_hist.insert(seq_no) = meta;
 
     return (y>0);
 }
@@ -99,9 +96,9 @@ void MyPred::spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool
 void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_dir, bool pred_dir, uint64_t next_pc) 
 {
 
-    auto it = br_hist.find(seq_no);
-    if(it == br_hist.end()) return;
-    BranchMetadata meta = it->second;
+    const BranchMetadata *found = br_hist.find(seq_no);
+    if(found == NULL) return;
+    BranchMetadata meta = *found;
 
     bool mispredicted = (pred_dir != resolve_dir);
     int t = resolve_dir ? 1 : -1;
@@ -125,6 +122,5 @@ void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_di
 
 void MyPred::commit(uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
-    // std::string br_id = get_br_id(seq_no, piece, pc);
     br_hist.erase(seq_no);
 }
\ No newline at end of file
@@ -1,18 +1,7 @@
 #include "my_pred.h"
 #include <cassert>
-#include <sstream>
 #include <stdio.h>
 
-// global variable
-MyPred my_pred;
-
-std::string MyPred::get_br_id(uint64_t seq_no, uint8_t piece, uint64_t pc)
-{
-    std::stringstream ss;
-    ss << seq_no << piece << pc;
-    return ss.str();
-}
-
 uint32_t MyPred::get_pht_index(uint64_t key)
 {
     return key % PHT_SIZE;
@@ -46,8 +35,7 @@ bool MyPred::predict(uint64_t seq_no, uint8_t piece, uint64_t pc)
     uint32_t index = get_pht_index(pa_ht[pa_ht_index]);
     assert(index < PHT_SIZE);
 
-    std::string br_id = get_br_id(seq_no, piece, pc);
-    br_hist.insert(std::pair<std::string, uint64_t>(br_id, pa_ht[pa_ht_index]));
+    br_hist.insert(seq_no) = pa_ht[pa_ht_index];
 
     return (pht[index] >= 2);
 }
@@ -78,11 +66,7 @@ void MyPred::spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool
 
 void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
 {
-    std::string br_id = get_br_id(seq_no, piece, pc);
-    auto it = br_hist.find(br_id);
-    assert(it != br_hist.end());
-
-    uint64_t ghr_to_use = it->second;
+    uint64_t ghr_to_use = br_hist.at(seq_no);
     uint32_t index = get_pht_index(ghr_to_use);
     assert(index < PHT_SIZE);
 
@@ -100,6 +84,5 @@ void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool reso
 
 void MyPred::commit(uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
-    std::string br_id = get_br_id(seq_no, piece, pc);
-    br_hist.erase(br_id);
+    br_hist.erase(seq_no);
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 #include <cstdint>
 #include <string>
-#include <unordered_map>
+#include "lib/inflight_table.h"
 
 #define HR_LEN 10
 #define paBHT_LEN 1024  // pre-address Branch Hitory Tablen 
@@ -25,9 +25,8 @@ private:
     // Technically, this information could have been stored
     // along with the instruction itself. But since we don't
     // have access to such APIs, we are storing it by ourselves.
-    std::unordered_map<std::string, uint64_t> br_hist;
+    inflight_table_t<uint64_t> br_hist;
 
-    std::string get_br_id(uint64_t, uint8_t, uint64_t);
     uint32_t get_pht_index(uint64_t);
     uint32_t get_pa_ht_index(uint64_t, uint8_t, uint64_t);
 
@@ -46,6 +45,3 @@ public:
 };
 
 #endif
-
-// global variable
-extern MyPred my_pred;
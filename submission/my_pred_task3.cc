@@ -1,18 +1,7 @@
 #include "my_pred.h"
 #include <cassert>
-#include <sstream>
 #include <stdio.h>
 
-// global variable
-MyPred my_pred;
-
-std::string MyPred::get_br_id(uint64_t seq_no, uint8_t piece, uint64_t pc)
-{
-    std::stringstream ss;
-    ss << seq_no << piece << pc;
-    return ss.str();
-}
-
 uint32_t MyPred::get_PAg_pht_index(uint64_t key)
 {
     return key % PAg_PHT_SIZE;
@@ -100,8 +89,7 @@ bool MyPred::predict(uint64_t seq_no, uint8_t piece, uint64_t pc)
     meta.gag_pred = gag_pred;
     meta.pag_pred = pag_pred;
 
-    std::string br_id = get_br_id(seq_no, piece, pc);
-    br_hist[br_id] = meta; 
+    br_hist.insert(seq_no) = meta;
 
     return final_decision;
 }
@@ -136,9 +124,7 @@ void MyPred::spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool
 
 void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_dir, bool pred_dir, uint64_t next_pc) 
 {
-    auto it = br_hist.find(get_br_id(seq_no, piece, pc));
-    assert(it != br_hist.end());
-    BranchMetadata meta = it->second;
+    BranchMetadata meta = br_hist.at(seq_no);
 
     uint32_t GAg_idx = meta.ghr_at_predict;
     uint32_t PAg_idx = meta.lhist_at_predict;
@@ -173,6 +159,5 @@ void MyPred::update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_di
 
 void MyPred::commit(uint64_t seq_no, uint8_t piece, uint64_t pc)
 {
-    std::string br_id = get_br_id(seq_no, piece, pc);
-    br_hist.erase(br_id);
+    br_hist.erase(seq_no);
 }
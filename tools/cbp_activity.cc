@@ -0,0 +1,27 @@
+// CBP Activity Trace Decoder
+//
+// Renders an activity trace recorded by cbp -L (see lib/activity_trace.h) as text, one line per event, in the
+// format the simulator used to print it in.
+//
+// Usage : cbp_activity <input.cbpa>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include "trace_reader.h"
+#include "activity_trace.h"
+
+int main(int argc, char **argv)
+{
+   if (argc != 2)
+   {
+      printf("usage:\t%s <input.cbpa>\n", argv[0]);
+      exit(0);
+   }
+
+   activity_trace_reader reader(argv[1]);
+   activity_event_t e;
+   while (reader.next(e))
+      std::cout << e << "\n";
+   return 0;
+}
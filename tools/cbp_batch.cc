@@ -0,0 +1,334 @@
+// CBP Batch Runner
+//
+// Simulates a list of traces in one process, each on its own uarchsim_t and predictor instance, and writes one
+// table of results (the DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS of cbp, for the full simulation and for
+// the last 50 Perc instructions).
+//
+// Traces are scheduled largest first on a pool of threads pinned to the CPUs the process may run on. The sorted
+// traces are dealt round-robin to per-thread queues; a thread takes its next trace from the front of its own queue
+// and, once it is empty, steals from the back (the smallest traces) of the other queues, so the pool stays busy
+// until the end without a thread being left with a large trace.
+//
+// Usage : cbp-batch [-m <name>] [-j <threads>] [-S <num_insts>] [-o <results_file>] [-a] <trace_list>
+//         trace_list has one trace per line (blank lines and lines starting with # are skipped).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cbp.h"
+#include "trace_reader.h"
+#include "fifo.h"
+#include "cache.h"
+#include "bp.h"
+#include "resource_schedule.h"
+#include "uarchsim.h"
+#include "parameters.h"
+#include "predictor_registry.h"
+
+struct batch_job_t
+{
+   std::string trace;
+   uint64_t size;
+   uarchsim_t::results_t results;
+   double exec_time;
+};
+
+struct worker_queue_t
+{
+   std::mutex lock;
+   std::deque<size_t> jobs;
+};
+
+static std::vector<batch_job_t> jobs;
+static std::vector<worker_queue_t> queues;
+static std::string pred_name = PREDICTOR_NAMES;
+static uint64_t sim_insts = 0;
+
+static std::mutex progress_lock;
+static size_t num_done = 0;
+
+// Same loop as cbp's main().
+static void run_job(batch_job_t &job)
+{
+   const auto start = std::chrono::steady_clock::now();
+
+   // The reader reports on stderr, stdout only gets the merged results table.
+   TraceReader reader(job.trace.c_str(), false, 0, std::cerr);
+   CondDirPredictor *cond_pred = create_registered_predictor(pred_name);
+   uarchsim_t *sim = new uarchsim_t(cond_pred);
+   sim->begin();
+
+   db_t inst_piece;
+   db_t *inst = reader.get_inst(inst_piece) ? &inst_piece : nullptr;
+   uint64_t inst_count = 1;
+   while (inst != nullptr)
+   {
+      sim->step(inst);
+      inst = reader.get_inst(inst_piece) ? &inst_piece : nullptr;
+      inst_count++;
+      if (sim_insts && inst_count >= sim_insts)
+      {
+         break;
+      }
+   }
+
+   cond_pred->endCondDirPredictor();
+   job.results = sim->results();
+   delete sim;
+   delete cond_pred;
+
+   job.exec_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Next job of worker id: the front of its own queue, else the back of another queue. Returns false when all are empty.
+static bool next_job(size_t id, size_t &job)
+{
+   for (size_t i = 0; i != queues.size(); i++)
+   {
+      worker_queue_t &queue = queues[(id + i) % queues.size()];
+      std::lock_guard<std::mutex> guard(queue.lock);
+      if (!queue.jobs.empty())
+      {
+         if (i == 0)
+         {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+         }
+         else
+         {
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+         }
+         return true;
+      }
+   }
+   return false;
+}
+
+static void worker(size_t id, int cpu)
+{
+   if (cpu >= 0)
+   {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(cpu, &cpus);
+      pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+   }
+
+   size_t job;
+   while (next_job(id, job))
+   {
+      run_job(jobs[job]);
+
+      std::lock_guard<std::mutex> guard(progress_lock);
+      num_done++;
+      fprintf(stderr, "[%lu/%lu] %s (thread %lu, %.1fs)\n", num_done, jobs.size(), jobs[job].trace.c_str(), id, jobs[job].exec_time);
+   }
+}
+
+static void write_results(FILE *f)
+{
+   fprintf(f, "%-40s %12s %12s %8s %10s %10s %9s %8s %10s %10s %10s %10s %10s %10s\n",
+           "Trace", "Instr", "Cycles", "IPC", "NumBr", "MispBr", "MR", "MPKI", "CycWP", "CycWPAvg", "CycWPPKI",
+           "50PercIPC", "50PercMPKI", "ExecTime");
+   double sum_ipc = 0;
+   double sum_mpki = 0;
+   for (const batch_job_t &job : jobs)
+   {
+      const bp_t::conddir_meas_t &full = job.results.conddir_full;
+      const bp_t::conddir_meas_t &half = job.results.conddir_half;
+      const double ipc = (double)full.instr / (double)full.cycles;
+      const double mpki = 1000.0 * (double)full.br_mispred / (double)full.instr;
+      const double cyc_wp_avg = (full.br_mispred == 0) ? 0.00 : (double)full.cycles_on_wrong_path / (double)full.br_mispred;
+      fprintf(f, "%-40s %12lu %12lu %8.4f %10lu %10lu %8.4f%% %8.4f %10lu %10.4f %10.4f %10.4f %10.4f %10.1f\n",
+              job.trace.c_str(), full.instr, full.cycles, ipc, full.br, full.br_mispred,
+              100.0 * (double)full.br_mispred / (double)full.br, mpki,
+              full.cycles_on_wrong_path, cyc_wp_avg, 1000.0 * (double)full.cycles_on_wrong_path / (double)full.instr,
+              (double)half.instr / (double)half.cycles, 1000.0 * (double)half.br_mispred / (double)half.instr,
+              job.exec_time);
+      sum_ipc += ipc;
+      sum_mpki += mpki;
+   }
+   fprintf(f, "%-40s %12s %12s %8.4f %10s %10s %9s %8.4f\n", "A-Mean", "", "", sum_ipc / jobs.size(), "", "", "", sum_mpki / jobs.size());
+}
+
+static void usage(const char *name)
+{
+   printf("usage:\t%s\n"
+          "\t[optional: -m <name> registered predictor to simulate (default: %s)]\n"
+          "\t[optional: -j <threads> (default: one per CPU, at most one per trace)]\n"
+          "\t[optional: -S <simulation_insts> number of insts to simulate per trace]\n"
+          "\t[optional: -o <results_file> also write the results table to a file]\n"
+          "\t[optional: -a do not pin threads to CPUs]\n"
+          "\t[REQUIRED: trace list file, one .gz or .cbpt trace per line]\n",
+          name, PREDICTOR_NAMES);
+   exit(0);
+}
+
+int main(int argc, char **argv)
+{
+   uint64_t num_threads = 0;
+   const char *results_name = nullptr;
+   bool pin = true;
+
+   int i = 1;
+   for (; i < argc && argv[i][0] == '-'; i++)
+   {
+      const bool has_value = (i + 1 < argc);
+      if (!strcmp(argv[i], "-m") && has_value)
+      {
+         pred_name = argv[++i];
+      }
+      else if (!strcmp(argv[i], "-j") && has_value)
+      {
+         if (sscanf(argv[++i], "%lu", &num_threads) != 1)
+         {
+            printf("Usage: missing threads: -j <threads>\n");
+            exit(0);
+         }
+      }
+      else if (!strcmp(argv[i], "-S") && has_value)
+      {
+         if (sscanf(argv[++i], "%lu", &sim_insts) != 1)
+         {
+            printf("Usage: missing sim insts: -S <num_insts>\n");
+            exit(0);
+         }
+      }
+      else if (!strcmp(argv[i], "-o") && has_value)
+      {
+         results_name = argv[++i];
+      }
+      else if (!strcmp(argv[i], "-a"))
+      {
+         pin = false;
+      }
+      else
+      {
+         usage(argv[0]);
+      }
+   }
+   if (i + 1 != argc)
+   {
+      usage(argv[0]);
+   }
+
+   // Fail on an unknown predictor before starting any thread.
+   delete create_registered_predictor(pred_name);
+
+   std::ifstream list(argv[i]);
+   if (!list)
+   {
+      printf("Cannot open trace list %s\n", argv[i]);
+      exit(1);
+   }
+   std::string line;
+   while (std::getline(list, line))
+   {
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+      line.erase(0, line.find_first_not_of(" \t"));
+      if (line.empty() || line[0] == '#')
+      {
+         continue;
+      }
+      struct stat st;
+      if (stat(line.c_str(), &st) != 0)
+      {
+         printf("Cannot open trace %s\n", line.c_str());
+         exit(1);
+      }
+      jobs.push_back({line, (uint64_t)st.st_size, {}, 0.0});
+   }
+   if (jobs.empty())
+   {
+      printf("No traces in %s\n", argv[i]);
+      exit(1);
+   }
+
+   // CPUs the process may run on.
+   std::vector<int> cpus;
+   cpu_set_t allowed;
+   if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+   {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+      {
+         if (CPU_ISSET(cpu, &allowed))
+         {
+            cpus.push_back(cpu);
+         }
+      }
+   }
+   if (num_threads == 0)
+   {
+      num_threads = cpus.empty() ? std::max(1u, std::thread::hardware_concurrency()) : cpus.size();
+   }
+   num_threads = std::min<uint64_t>(num_threads, jobs.size());
+
+   // Largest traces first, dealt round-robin so that every thread starts with one of the largest.
+   std::vector<size_t> order(jobs.size());
+   for (size_t j = 0; j != order.size(); j++)
+   {
+      order[j] = j;
+   }
+   std::stable_sort(order.begin(), order.end(), [](size_t a, size_t b) { return jobs[a].size > jobs[b].size; });
+   queues = std::vector<worker_queue_t>(num_threads);
+   for (size_t j = 0; j != order.size(); j++)
+   {
+      queues[j % num_threads].jobs.push_back(order[j]);
+   }
+
+   fprintf(stderr, "Running %lu traces on %lu threads (%s), predictor %s\n", jobs.size(), num_threads, (pin && !cpus.empty()) ? "pinned" : "not pinned", pred_name.c_str());
+   const auto start = std::chrono::steady_clock::now();
+
+   // Whatever the predictors and the simulator print while the traces run goes to stderr, so that stdout only
+   // gets the results table.
+   fflush(stdout);
+   std::cout.flush();
+   const int table_fd = dup(STDOUT_FILENO);
+   dup2(STDERR_FILENO, STDOUT_FILENO);
+
+   std::vector<std::thread> threads;
+   for (size_t t = 0; t != num_threads; t++)
+   {
+      const int cpu = (pin && !cpus.empty()) ? cpus[t % cpus.size()] : -1;
+      threads.emplace_back(worker, t, cpu);
+   }
+   for (std::thread &thread : threads)
+   {
+      thread.join();
+   }
+
+   fflush(stdout);
+   std::cout.flush();
+   dup2(table_fd, STDOUT_FILENO);
+   close(table_fd);
+
+   fprintf(stderr, "Total wall time: %.1f seconds\n", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+   write_results(stdout);
+   if (results_name)
+   {
+      FILE *f = fopen(results_name, "w");
+      if (f == nullptr)
+      {
+         printf("Cannot create %s\n", results_name);
+         exit(1);
+      }
+      write_results(f);
+      fclose(f);
+   }
+   return 0;
+}
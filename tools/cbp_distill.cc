@@ -0,0 +1,57 @@
+// CBP Branch Stream Distiller
+//
+// Makes one pass over a trace and writes the branch stream replayed by cbp_replay (see lib/branch_stream.h).
+// seq_no and piece are numbered exactly as uarchsim_t::step() numbers them.
+//
+// Usage : cbp_distill <input_trace.gz|.cbpt> <output.cbpb>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace_reader.h"
+#include "branch_stream.h"
+
+int main(int argc, char **argv)
+{
+   if (argc != 3)
+   {
+      printf("usage:\t%s <input_trace.gz|.cbpt> <output.cbpb>\n", argv[0]);
+      exit(0);
+   }
+
+   TraceReader reader(argv[1]);
+   branch_stream_writer writer(argv[2]);
+   if (!writer.is_open())
+   {
+      fprintf(stderr, "Cannot create %s\n", argv[2]);
+      exit(1);
+   }
+
+   db_t inst;
+   uint64_t seq_no = 0;
+   uint64_t num_inst = 0;
+   uint8_t piece = 0;
+   uint64_t num_records = 0;
+   while (reader.get_inst(inst))
+   {
+      if (is_branch_stream_uop(inst.insn_class, inst.pc, inst.next_pc))
+      {
+         writer.write({seq_no, piece, inst.pc, inst.insn_class, inst.is_taken, inst.next_pc});
+         num_records++;
+      }
+
+      seq_no++;
+      if (inst.is_last_piece)
+      {
+         num_inst++;
+         piece = 0;
+      }
+      else
+      {
+         piece++;
+      }
+   }
+
+   writer.finish(seq_no, num_inst);
+   printf("Distilled %lu branch records out of %lu micro-ops (%lu instructions) to %s\n", num_records, seq_no, num_inst, argv[2]);
+   return 0;
+}
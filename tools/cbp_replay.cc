@@ -0,0 +1,54 @@
+// CBP Branch Stream Replay
+//
+// Replays a branch stream written by cbp_distill into registered predictors (the ones linked with the simulator,
+// see cbp.h), without decoding the trace or modelling timing, and prints the bp_t branch prediction measurements.
+// See lib/predictor_driver.h for how the hooks are driven. With several predictor names, each of them is replayed
+// in the same pass, with its own measurements.
+//
+// Usage : cbp_replay <input.cbpb> [update_delay_uops] [name,name...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "branch_stream.h"
+#include "parameters.h"
+#include "predictor_driver.h"
+#include "predictor_registry.h"
+
+int main(int argc, char **argv)
+{
+   if (argc < 2 || argc > 4)
+   {
+      printf("usage:\t%s <input.cbpb> [update_delay_uops (default: 0)] [registered predictors: name,name... (default: %s)]\n", argv[0], PREDICTOR_NAMES);
+      exit(0);
+   }
+
+   uint64_t update_delay = 0;
+   if (argc >= 3 && sscanf(argv[2], "%lu", &update_delay) != 1)
+   {
+      printf("Usage: invalid update delay: %s\n", argv[2]);
+      exit(0);
+   }
+
+   const std::vector<std::string> pred_names = split_predictor_names((argc == 4) ? argv[3] : PREDICTOR_NAMES);
+   if (pred_names.empty())
+   {
+      printf("Usage: missing predictor name\n");
+      exit(0);
+   }
+
+   branch_stream_reader reader(argv[1]);
+
+   predictor_driver_t driver(update_delay, pred_names);
+   driver.begin();
+
+   branch_record_t rec;
+   while (reader.next(rec))
+   {
+      driver.step(rec.seq_no, rec.piece, rec.insn_class, rec.taken, rec.pc, rec.next_pc);
+   }
+   driver.finish(reader.get_num_uops(), reader.get_num_instr());
+
+   driver.end();
+   driver.output();
+   return 0;
+}
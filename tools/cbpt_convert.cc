@@ -0,0 +1,60 @@
+// CBP Trace Converter
+//
+// Converts a gz trace into the memory-mapped .cbpt format (see lib/cbpt_trace.h).
+// The gz trace is decoded with TraceReader, so both formats feed readInstr() exactly the same fields.
+//
+// Usage : cbpt_convert <input_trace.gz> <output_trace.cbpt>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace_reader.h"
+#include "cbpt_trace.h"
+
+int main(int argc, char **argv)
+{
+   if (argc != 3 || !is_cbpt_trace(argv[2]))
+   {
+      printf("usage:\t%s <input_trace.gz> <output_trace.cbpt>\n", argv[0]);
+      exit(0);
+   }
+
+   TraceReader reader(argv[1]);
+   cbpt_writer writer(argv[2]);
+   if (!writer.is_open())
+   {
+      fprintf(stderr, "Cannot create %s\n", argv[2]);
+      exit(1);
+   }
+
+   while (reader.decodeGzInstr())
+   {
+      const TraceReader::Instr &instr = reader.mInstr;
+
+      uint8_t flags = 0;
+      uint64_t addr = 0;
+      if (is_mem(instr.mType))
+      {
+         addr = instr.mEffAddr;
+         flags |= instr.mBaseUpd ? CBPT_BASE_UPD : 0;
+         flags |= instr.mHasRegOffset ? CBPT_REG_OFFSET : 0;
+      }
+      if (is_br(instr.mType) && instr.mTaken)
+      {
+         addr = instr.mNextPc;
+         flags |= CBPT_TAKEN;
+      }
+
+      writer.write(static_cast<uint8_t>(instr.mType), instr.mPc, addr, flags, instr.mMemSize,
+                   instr.mInRegs.data(), instr.mNumInRegs, instr.mOutRegs.data(), instr.mNumOutRegs,
+                   instr.mRawOutRegsValues.data(), instr.mRawOutRegsValues.size());
+
+      // decodeGzInstr() appends to the register lists, clear them for the next instruction.
+      reader.mInstr.reset();
+      // decodeGzInstr() does not count instructions (readInstr() does), count them for the reader's " Read N instrs ".
+      reader.nInstr++;
+   }
+
+   writer.finish();
+   printf("Converted %lu instructions to %s\n", writer.get_num_instr(), argv[2]);
+   return 0;
+}
@@ -0,0 +1,46 @@
+// CBP Trace Index Builder
+//
+// Builds the sidecar index (<trace>.tidx) that lets cbp start at any trace instruction (-J) without
+// inflating the trace from the beginning (see lib/trace_index.h).
+//
+// Usage : trace_index <input_trace.gz> [span_MB]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace_index.h"
+
+int main(int argc, char **argv)
+{
+   if (argc < 2 || argc > 3)
+   {
+      printf("usage:\t%s <input_trace.gz> [span_MB (default: %lu)]\n", argv[0], TRACE_INDEX_DEFAULT_SPAN >> 20);
+      exit(0);
+   }
+
+   uint64_t span = TRACE_INDEX_DEFAULT_SPAN;
+   if (argc == 3)
+   {
+      uint64_t span_mb;
+      if (sscanf(argv[2], "%lu", &span_mb) != 1 || span_mb == 0)
+      {
+         printf("Usage: invalid span: %s\n", argv[2]);
+         exit(0);
+      }
+      span = span_mb << 20;
+   }
+
+   const std::string index_name = trace_index_name(argv[1]);
+   if (!build_trace_index(argv[1], index_name.c_str(), span))
+   {
+      exit(1);
+   }
+
+   trace_index index;
+   if (!index.load(index_name.c_str()))
+   {
+      fprintf(stderr, "Cannot read back %s\n", index_name.c_str());
+      exit(1);
+   }
+   printf("Indexed %lu instructions in %s\n", index.get_num_instr(), index_name.c_str());
+   return 0;
+}